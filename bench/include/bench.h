@@ -0,0 +1,55 @@
+/**
+ * @file bench.h
+ * @brief This file contains a small harness for micro-benchmarks of the framework primitives.
+ *
+ * Every benchmark case times its body in batches and prints one tab separated row with the
+ * distribution of the per-operation cost, so runs of different versions can be compared.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <string>
+#include <vector>
+#include <functional>
+
+using namespace std;
+
+/**
+ * @brief Prints the header of the result table.
+ */
+void bench_header();
+
+/**
+ * @brief Times a benchmark body and prints its cost per operation.
+ *
+ * @param name Name of the benchmark case.
+ * @param n The size parameter of the case (e.g. number of tasks), printed in the table.
+ * @param batches The number of timed batches.
+ * @param batch_size The number of calls of body per batch.
+ * @param body The operation to measure.
+ */
+void bench_run(const string &name, long n, int batches, int batch_size, const function<void()> &body);
+
+/**
+ * @brief Prints the distribution of samples that were timed by the caller, like bench_run() does.
+ *
+ * @param name Name of the benchmark case.
+ * @param n The size parameter of the case, printed in the table.
+ * @param samples The cost of every sample in nanoseconds, sorted in place.
+ */
+void bench_report(const string &name, long n, vector<double> &samples);
+
+/**
+ * @brief Returns a monotonic timestamp in nanoseconds.
+ */
+long bench_now_ns();
+
+/* Benchmark cases */
+void bench_message();
+void bench_timeline();
+void bench_fork();
+void bench_pipe();
+void bench_scheduler();
+
+#endif
@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include <algorithm>
+
+#include <bench.h>
+
+long bench_now_ns()
+{
+    struct timespec spec;
+    clock_gettime(CLOCK_MONOTONIC, &spec);
+    return (spec.tv_sec * 1000000000L) + spec.tv_nsec;
+}
+
+void bench_header()
+{
+    printf("name\tn\tsamples\tmean_ns\tp50_ns\tp90_ns\tp99_ns\tmax_ns\n");
+}
+
+void bench_run(const string &name, long n, int batches, int batch_size, const function<void()> &body)
+{
+    vector<double> samples;
+    samples.reserve(batches);
+
+    // Warm up caches and lazily allocated state
+    for (int i = 0; i < batch_size; i++)
+        body();
+
+    for (int b = 0; b < batches; b++)
+    {
+        long start = bench_now_ns();
+
+        for (int i = 0; i < batch_size; i++)
+            body();
+
+        samples.push_back(static_cast<double>(bench_now_ns() - start) / batch_size);
+    }
+
+    bench_report(name, n, samples);
+}
+
+void bench_report(const string &name, long n, vector<double> &samples)
+{
+    if (samples.empty())
+        return;
+
+    sort(samples.begin(), samples.end());
+
+    double sum = 0;
+    for (double s : samples)
+        sum += s;
+
+    auto percentile = [&](double p) { return samples[static_cast<size_t>(p * (samples.size() - 1))]; };
+
+    printf("%s\t%ld\t%zu\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\n",
+        name.c_str(), n, samples.size(), sum / samples.size(),
+        percentile(0.50), percentile(0.90), percentile(0.99), samples.back());
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+    struct { const char *group; void (*run)(); } groups[] = {
+        { "message", bench_message },
+        { "timeline", bench_timeline },
+        { "fork", bench_fork },
+        { "pipe", bench_pipe },
+        { "scheduler", bench_scheduler },
+    };
+
+    bench_header();
+
+    // Without arguments every group runs, otherwise only the named ones
+    for (auto &g : groups)
+    {
+        bool selected = argc == 1;
+
+        for (int i = 1; i < argc; i++)
+            selected |= !strcmp(argv[i], g.group);
+
+        if (selected)
+            g.run();
+    }
+
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <bench.h>
+
+// A job is a fork of the scheduler, the cost of the fork grows with the memory the parent touched
+static void fork_exit_wait()
+{
+    pid_t pid = fork();
+
+    if (pid == -1)
+    {
+        perror("fork");
+        exit(EXIT_FAILURE);
+    }
+    else if (pid == 0)
+    {
+        _exit(0);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+}
+
+void bench_fork()
+{
+    long sizes[] = { 0, 16, 128 };
+
+    for (long mb : sizes)
+    {
+        size_t bytes = mb * 1024 * 1024;
+        char *resident = bytes ? (char*)malloc(bytes) : NULL;
+
+        if (resident)
+            memset(resident, 1, bytes);
+
+        // n is the resident memory of the parent in MB
+        bench_run("fork_exit_wait", mb, 100, 10, fork_exit_wait);
+
+        free(resident);
+    }
+}
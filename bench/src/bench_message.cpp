@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include <vector>
+
+#include <bench.h>
+#include <channel.h>
+#include <flight_controller.h>
+
+static volatile bool g_sink;
+
+// The text payload the flight controller used before the typed messages
+static void text_round_trip(char *buffer, size_t size)
+{
+    snprintf(buffer, size, "%d %.2f %.2f %.2f", CORRECT_VECTOR, 1.0198, 0.9801, 1.0001);
+
+    int command = 0;
+    double roll = 0.0, pitch = 0.0, yaw = 0.0;
+    int parsed = sscanf(buffer, "%d %lf %lf %lf", &command, &roll, &pitch, &yaw);
+
+    g_sink = parsed == 4 && !strcmp(buffer, "2 1.02 0.98 1.00");
+}
+
+static void binary_round_trip(attitude_message &msg)
+{
+    msg.command = CORRECT_VECTOR;
+    msg.roll = 1.0198;
+    msg.pitch = 0.9801;
+    msg.yaw = 1.0001;
+    message_seal(msg);
+
+    g_sink = message_valid(msg) && attitude_expected(msg);
+}
+
+#define HANDOFF_WARMUP 1000
+#define HANDOFF_SAMPLES 100000
+
+/**
+ * The producer and the consumer of a channel run in separate processes pinned to different CPUs, like a task
+ * and its consumer on two cores. The producer stamps every message with CLOCK_MONOTONIC, which is the same
+ * clock on every core, and the consumer takes the one-way hand-off latency when the message arrives. The
+ * consumer answers on a second channel, so one message is in flight at a time and the round trip is timed too.
+ */
+static void wait_readable(Channel *c)
+{
+    // Spin on the ring, yield now and then in case both sides share a CPU
+    for (unsigned spins = 1; !c->readable(); spins++)
+    {
+        if (spins % 1024 == 0)
+            sched_yield();
+    }
+}
+
+static void pin(int cpu)
+{
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+
+    if (sched_setaffinity(0, sizeof(cpuset), &cpuset) != 0)
+        perror("sched_setaffinity");
+}
+
+static void channel_handoff()
+{
+    cpu_set_t allowed;
+    int cpus[2] = { 0, 0 };
+    int found = 0;
+
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0)
+    {
+        for (int i = 0; i < CPU_SETSIZE && found < 2; i++)
+        {
+            if (CPU_ISSET(i, &allowed))
+                cpus[found++] = i;
+        }
+    }
+
+    if (found < 2)
+    {
+        fprintf(stderr, "message_channel_handoff: only one CPU, the hand-off includes context switches\n");
+        cpus[1] = cpus[0];
+    }
+
+    Channel *ping = Channel::declare_channel("bench_handoff_ping");
+    Channel *pong = Channel::declare_channel("bench_handoff_pong");
+    uint64_t sent;
+
+    // The child prints its own row, nothing buffered may be printed twice
+    fflush(stdout);
+
+    pid_t pid = fork();
+
+    if (pid == -1)
+    {
+        perror("fork");
+        exit(EXIT_FAILURE);
+    }
+    else if (pid == 0)
+    {
+        pin(cpus[1]);
+
+        vector<double> one_way;
+        one_way.reserve(HANDOFF_SAMPLES);
+
+        for (int i = 0; i < HANDOFF_WARMUP + HANDOFF_SAMPLES; i++)
+        {
+            wait_readable(ping);
+            ping->read_raw(&sent, sizeof(sent));
+
+            long now = bench_now_ns();
+
+            if (i >= HANDOFF_WARMUP)
+                one_way.push_back(now - (long)sent);
+
+            pong->write_raw(&sent, sizeof(sent));
+        }
+
+        bench_report("message_channel_handoff_one_way", sizeof(sent), one_way);
+        _exit(EXIT_SUCCESS);
+    }
+
+    pin(cpus[0]);
+
+    vector<double> round_trip;
+    round_trip.reserve(HANDOFF_SAMPLES);
+
+    for (int i = 0; i < HANDOFF_WARMUP + HANDOFF_SAMPLES; i++)
+    {
+        sent = bench_now_ns();
+        ping->write_raw(&sent, sizeof(sent));
+
+        wait_readable(pong);
+        pong->read_raw(&sent, sizeof(sent));
+
+        if (i >= HANDOFF_WARMUP)
+            round_trip.push_back(bench_now_ns() - (long)sent);
+    }
+
+    waitpid(pid, NULL, 0);
+    bench_report("message_channel_handoff_round_trip", sizeof(sent), round_trip);
+
+    sched_setaffinity(0, sizeof(allowed), &allowed);
+}
+
+void bench_message()
+{
+    char buffer[64];
+    attitude_message msg = {};
+
+    bench_run("message_text_encode_decode", 1, 1000, 100, [&]() { text_round_trip(buffer, sizeof(buffer)); });
+    bench_run("message_binary_encode_decode", 1, 1000, 100, [&]() { binary_round_trip(msg); });
+
+    // Including the hand-off through a shared memory channel
+    Channel *c = Channel::declare_channel("bench_message");
+
+    bench_run("message_text_channel", 1, 1000, 100, [&]() {
+        snprintf(buffer, sizeof(buffer), "%d %.2f %.2f %.2f", CORRECT_VECTOR, 1.0198, 0.9801, 1.0001);
+        c->write_data(buffer);
+        c->read_data(buffer, sizeof(buffer));
+
+        int command = 0;
+        double roll = 0.0, pitch = 0.0, yaw = 0.0;
+        g_sink = sscanf(buffer, "%d %lf %lf %lf", &command, &roll, &pitch, &yaw) == 4 && !strcmp(buffer, "2 1.02 0.98 1.00");
+    });
+
+    bench_run("message_binary_channel", 1, 1000, 100, [&]() {
+        msg.command = CORRECT_VECTOR;
+        msg.roll = 1.0198;
+        msg.pitch = 0.9801;
+        msg.yaw = 1.0001;
+        c->write_message(msg);
+        g_sink = c->read_message(msg) && attitude_expected(msg);
+    });
+
+    // Between a producer and a consumer process on two CPUs
+    channel_handoff();
+}
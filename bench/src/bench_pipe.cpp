@@ -0,0 +1,66 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include <bench.h>
+#include <pipe.h>
+
+static volatile bool g_sink;
+
+/**
+ * A job closes the ends of a pipe it does not use, and (unless WORKER_POOL is defined) the end it used
+ * when it is done. The descriptors of the benchmark pipe are restored with dup2() before every call,
+ * pipe_reopen measures that part alone.
+ */
+static int g_read_fd, g_write_fd;
+static Pipe *g_pipe;
+
+static void reopen()
+{
+    dup2(g_read_fd, g_pipe->get_read_fd());
+    dup2(g_write_fd, g_pipe->get_write_fd());
+}
+
+void bench_pipe()
+{
+    int fds[2];
+    if (pipe(fds) == -1)
+    {
+        perror("pipe");
+        exit(EXIT_FAILURE);
+    }
+
+    g_read_fd = fds[0];
+    g_write_fd = fds[1];
+    g_pipe = Pipe::declare_pipe("bench_pipe");
+
+    char text[64];
+    snprintf(text, sizeof(text), "%d %.2f %.2f %.2f", 2, 1.0198, 0.9801, 1.0001);
+    char buffer[PIPE_BUF + 1];
+
+    bench_run("pipe_reopen", 1, 1000, 100, reopen);
+
+    // The text interface, one write_data() by the producer and one read_data() by the consumer
+    bench_run("pipe_write_read_data", strlen(text) + 1, 1000, 100, [&]() {
+        reopen();
+        g_pipe->write_data(text);
+        reopen();
+        g_sink = g_pipe->read_data(buffer, sizeof(buffer));
+    });
+
+    // Throughput of the message interface, n is the message size in bytes (at most PIPE_BUF)
+    size_t sizes[] = { 64, 512, PIPE_BUF };
+
+    for (size_t size : sizes)
+    {
+        memset(buffer, 1, size);
+
+        bench_run("pipe_write_read_raw", size, 1000, 100, [&]() {
+            reopen();
+            g_pipe->write_raw(buffer, size);
+            reopen();
+            g_sink = g_pipe->read_raw(buffer, size);
+        });
+    }
+}
@@ -0,0 +1,169 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include <bench.h>
+#include <scheduler.h>
+#include <pipe.h>
+
+static volatile bool g_sink;
+
+static void noop() {}
+
+// Declares a task with n pipe inputs, every input holds one message if full is set
+static task* task_with_inputs(const string &name, int n, bool full, vector<Pipe*> &pipes)
+{
+    task *t = task::declare_task(name, 0, 0, 1, noop);
+
+    for (int i = 0; i < n; i++)
+    {
+        Pipe *p = Pipe::declare_pipe(name.c_str());
+        t->add_input(p, 1);
+        pipes.push_back(p);
+
+        if (full)
+            write(p->get_write_fd(), "1", 1);
+    }
+
+    return t;
+}
+
+// Every case declares its own pipes, the descriptors of a case are closed before the next one
+static void close_pipes(vector<Pipe*> &pipes)
+{
+    for (Pipe *p : pipes)
+    {
+        close(p->get_read_fd());
+        close(p->get_write_fd());
+    }
+
+    pipes.clear();
+}
+
+// The readiness check of a data-driven task whose inputs are full: once they were seen readable only the bitmap is compared,
+// after a run every input is probed again
+static void bench_input_full()
+{
+    int inputs[] = { 1, 4, 16, 64 };
+    vector<Pipe*> pipes;
+
+    for (int n : inputs)
+    {
+        task *t = task_with_inputs("bench_input_full", n, true, pipes);
+
+        bench_run("task_input_full", n, 1000, 100, [&]() { g_sink = t->task_input_full(t); });
+        bench_run("task_input_probe", n, 1000, 100, [&]() { t->get_inputs().clear_ready(); g_sink = t->task_input_full(t); });
+
+        close_pipes(pipes);
+    }
+}
+
+// One scheduler pass over n tasks that wait on an empty input: the fixed cost of a tick without dispatches.
+// Waiting tasks are not visited, so the cost stays flat from 1 to thousands of tasks
+static void bench_tick()
+{
+    int tasks[] = { 1, 8, 64, 256, 1024, 4096 };
+    vector<Pipe*> pipes;
+
+    // Every task takes the two descriptors of its pipe
+    struct rlimit files;
+    if (getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur < files.rlim_max)
+    {
+        files.rlim_cur = files.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &files);
+    }
+
+    for (int n : tasks)
+    {
+        if (getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur != RLIM_INFINITY && 2 * (rlim_t)n + 64 > files.rlim_cur)
+        {
+            fprintf(stderr, "Skipping scheduler_tick %d: %d pipes do not fit in %lu descriptors\n", n, n, (unsigned long)files.rlim_cur);
+            continue;
+        }
+
+        scheduler *s = scheduler::declare_scheduler("bench_tick");
+        s->init_cores(NUM_OF_CORES);
+
+        for (int i = 0; i < n; i++)
+            s->add_task(task_with_inputs("bench_tick", 1, false, pipes));
+
+        s->init_deadlines();
+        s->init_task_sets();
+
+        bench_run("scheduler_tick", n, 1000, 10, [&]() {
+            s->monitor_tasks();
+            s->run_tasks();
+        });
+
+        close_pipes(pipes);
+    }
+}
+
+// Placing a job and completing it again, so the runs and the order of the core heaps change every call
+static void bench_find_core()
+{
+    int cores[] = { 4, 16, 64, 256 };
+
+    for (int n : cores)
+    {
+        scheduler *s = scheduler::declare_scheduler("bench_find_core");
+        s->init_cores(n);
+
+        bench_run("find_core", n, 1000, 100, [&]() {
+            core *c = s->get_core(s->find_core(false));
+            c->increase_runs();
+            c->set_active(false);
+        });
+
+        bench_run("find_core_voter", n, 1000, 100, [&]() {
+            core *c = s->get_core(s->find_core(true));
+            c->increase_runs();
+            c->set_active(false);
+        });
+    }
+}
+
+static void set_states(vector<task*> &replicates, task_state state)
+{
+    for (task *t : replicates)
+        t->set_state(state);
+}
+
+// The voter checks of every tick while its replicates run, and a full round from arming to the vote
+static void bench_voter()
+{
+    int replicas[] = { 3, 5, 9, 33 };
+
+    for (int n : replicas)
+    {
+        voter *v = voter::declare_voter("bench_voter", 0, 0, 1, noop, voter_type::standard);
+        vector<task*> replicates;
+
+        for (int i = 0; i < n; i++)
+        {
+            replicates.push_back(task::declare_task("bench_replicate", 0, 0, 1, noop));
+            v->add_replicate(replicates.back());
+        }
+
+        set_states(replicates, task_state::running);
+        v->get_voter_fireable();
+
+        bench_run("voter_fireable_waiting", n, 1000, 100, [&]() { g_sink = v->get_voter_fireable(); });
+
+        bench_run("voter_fireable_round", n, 1000, 100, [&]() {
+            set_states(replicates, task_state::running);
+            v->get_voter_fireable();
+            set_states(replicates, task_state::idle);
+            g_sink = v->get_voter_fireable();
+        });
+    }
+}
+
+void bench_scheduler()
+{
+    bench_input_full();
+    bench_tick();
+    bench_find_core();
+    bench_voter();
+}
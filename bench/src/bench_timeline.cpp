@@ -0,0 +1,23 @@
+#include <bench.h>
+#include <timeline.h>
+#include <defines.h>
+
+void bench_timeline()
+{
+    timeline tl;
+    tl.init(EVENT_TRACE_SLOTS, bench_now_ns());
+
+    int task = 0;
+    uint64_t time = bench_now_ns();
+
+    // Most events reuse the timestamp the scheduler already took for the latency histograms
+    bench_run("timeline_record", 1, 1000, 1000, [&]() {
+        tl.record(time++, timeline_dispatch, task, task % NUM_OF_CORES, 0);
+        task = (task + 1) & 7;
+    });
+
+    // The votes, cancels and log samples read the clock themselves
+    bench_run("timeline_record_clock", 1, 1000, 1000, [&]() {
+        tl.record(bench_now_ns(), timeline_log, -1, -1, 0);
+    });
+}
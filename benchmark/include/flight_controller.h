@@ -1,6 +1,11 @@
 #ifndef FLIGHT_CONTROLLER_H
 #define FLIGHT_CONTROLLER_H
 
+#include <stdint.h>
+#include <message.h>
+
+#define FC_REPLICAS 3                       // Replicates of task B in the NMR and RAV-NMR graphs
+
 // Commands for stabilization
 enum Command {
     NO_ACTION,
@@ -8,8 +13,40 @@ enum Command {
     CORRECT_VECTOR
 };
 
+// Sent by task A: the command and the filtered roll and pitch
+typedef struct sensor_message {
+    static constexpr uint8_t message_id = 1;
+    static constexpr uint8_t message_version = 1;
+
+    message_header header;
+    int32_t command;
+    int32_t padding;
+    double roll;
+    double pitch;
+} sensor_message;
+
+// Sent by task B (and the voter): the command and the stabilized angles
+typedef struct attitude_message {
+    static constexpr uint8_t message_id = 2;
+    static constexpr uint8_t message_version = 1;
+
+    message_header header;
+    int32_t command;
+    int32_t padding;
+    double roll;
+    double pitch;
+    double yaw;
+} attitude_message;
+
+// Values are compared with the precision of the former "%.2f" text payloads
+bool sensor_expected(const sensor_message &msg);
+bool attitude_expected(const attitude_message &msg);
+bool attitude_equal(const attitude_message &lhs, const attitude_message &rhs);
+
+// The ballot digest of a replicate output, outputs that are attitude_equal() share it unless a value sits on a rounding boundary
+uint64_t attitude_digest(const attitude_message &msg);
+
 void read_sensors(void);
-void process_data(void);
 void process_data_1(void);
 void process_data_2(void);
 void process_data_3(void);
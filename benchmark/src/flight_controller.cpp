@@ -1,4 +1,3 @@
-
 #include <array>
 #include <math.h>
 #include <time.h>
@@ -6,33 +5,33 @@
 
 #include <defines.h>
 #include <pipe.h>
+#include <task.h>
+#include <e2e.h>
 
 #include <flight_controller.h>
 
-// Declare the pipes here
-#if defined(NMR) || defined(RAVNMR)
-extern Pipe *AB_1;
-extern Pipe *AB_2;
-extern Pipe *AB_3;
-extern Pipe *BV_1;
-extern Pipe *BV_2;
-extern Pipe *BV_3;
+// Declare the pipes here, the graph of the redundancy mode sets the ones it uses (see main.cpp)
+extern int REPLICAS;
+extern Pipe *AB[FC_REPLICAS];
+extern Pipe *BV[FC_REPLICAS];
 extern Pipe *VC;
-#else
-extern Pipe *AB;
-extern Pipe *BC;
-#endif
+extern uint32_t PATH_B[FC_REPLICAS];
+
+extern e2e_tracker *E2E;
 
-#if defined(NMR) || defined(RAVNMR)
 /**************************************
- * (RAV)-NMR
+ * Task A, sends the sample to every replicate of task B
  ************************************ */ 
 void read_sensors(void)
 {
 #ifdef DEBUG
-    printf("task A-1\n");
+    printf("task A\n");
 #endif
 
+    // The sample is taken now, the filter below runs on it
+    sensor_message msg = {};
+    message_originate(msg, E2E->next_chain());
+
     // Simulated sensor values
     double accelRoll     = 12.5;
     double accelPitch    = -8.0;
@@ -47,7 +46,7 @@ void read_sensors(void)
 
     // Busy loop to simulate some processing time
     Timer timer;
-    while (!timer.hasElapsedMilliseconds(TASK_BUSY_TIME))
+    while (!timer.hasElapsedMilliseconds(CONFIG.busy_time))
     {
         // Apply complementary filter
         estimated_roll  = alpha * (estimated_roll  + gyroRollRate  * 0.01)
@@ -60,43 +59,40 @@ void read_sensors(void)
     Command sensorCommand = CALCULATE_VECTOR;
 
     // Send only what Task B needs: command, roll, pitch
-    char buffer[64];
-    snprintf(buffer, sizeof(buffer), "%d %.2f %.2f",
-             static_cast<int>(sensorCommand), estimated_roll, estimated_pitch);
+    msg.command = sensorCommand;
+    msg.roll    = estimated_roll;
+    msg.pitch   = estimated_pitch;
 
-    AB_1->write_data(buffer);
-    AB_2->write_data(buffer);
-    AB_3->write_data(buffer);
+    for (int r = 0; r < REPLICAS; r++)
+        AB[r]->write_message(msg);
 
-    exit(0);
+    task_exit(0);
 }
 
-void process_data_1(void)
+
+/**************************************
+ * Task B, one replicate per NMR replica, the only one in the baseline
+ ************************************ */ 
+static void process_data(int replica)
 {
 #ifdef DEBUG
-    printf("task B-1\n");
+    printf("task B-%d\n", replica + 1);
 #endif
 
-    // Read from pipe AB_1
-    char buffer[64] = {0};
-    if (!AB_1->read_data(buffer, sizeof(buffer))) {        
-        exit(1);
+    // Read from pipe AB of the replicate
+    sensor_message in;
+    if (!AB[replica]->read_message(in)) {
+        task_exit(1);
     }
 
-    if (strcmp(buffer, "1 12.60 -8.05" ))
-        exit(2);
+    if (!sensor_expected(in))
+        task_exit(2);
 
 #ifdef DEBUG
-    printf("Buffer: [%s] \n", buffer);
+    printf("Input: [%d %.2f %.2f] \n", in.command, in.roll, in.pitch);
 #endif
 
-    int cmdInt = 0;
-    double roll_in=0.0, pitch_in=0.0;
-    int parsed = sscanf(buffer, "%d %lf %lf", &cmdInt, &roll_in, &pitch_in);
-    if (parsed != 3) {
-        //printf("DEBUG B: parse error, buffer=%s\n", buffer);
-        exit(1);
-    }    
+    double roll_in = in.roll, pitch_in = in.pitch;
 
     // We'll store a "running" stabilized angles. Start from the input.
     double stabilizedRoll  = roll_in;
@@ -104,7 +100,7 @@ void process_data_1(void)
     double stabilizedYaw   = 0.0;  // assume 0 for demonstration
 
     Timer timer;
-    while (!timer.hasElapsedMilliseconds(TASK_BUSY_TIME))
+    while (!timer.hasElapsedMilliseconds(CONFIG.busy_time))
     {
         // Convert degrees to radians
         double radRoll  = stabilizedRoll  * M_PI / 180.0;
@@ -150,402 +146,87 @@ void process_data_1(void)
     Command sensorCommand = CORRECT_VECTOR;
 
     // Send only what Task C needs: command, stabilizedRoll, stabilizedPitch, stabilizedYaw
-    snprintf(buffer, sizeof(buffer), "%d %.2f %.2f %.2f",
-             sensorCommand, stabilizedRoll, stabilizedPitch, stabilizedYaw);
-    BV_1->write_data(buffer);    
-
-    exit(0);
+    attitude_message out = {};
+    out.command = sensorCommand;
+    out.roll    = stabilizedRoll;
+    out.pitch   = stabilizedPitch;
+    out.yaw     = stabilizedYaw;
+    message_forward(out, in, PATH_B[replica]);
+    BV[replica]->write_message(out);
+    task_vote(out.header.chain, attitude_digest(out));
+
+    task_exit(0);
 }
 
-void process_data_2(void) 
+void process_data_1(void)
 {
-#ifdef DEBUG
-    printf("task B-2\n");
-#endif
-
-    // Read from pipe AB_1
-    char buffer[64] = {0};
-    if (!AB_2->read_data(buffer, sizeof(buffer))) {        
-        exit(1);
-    }
-
-    if (strcmp(buffer, "1 12.60 -8.05" ))
-        exit(2);
-
-    int cmdInt = 0;
-    double roll_in=0.0, pitch_in=0.0;
-    int parsed = sscanf(buffer, "%d %lf %lf", &cmdInt, &roll_in, &pitch_in);
-    if (parsed != 3) {        
-        exit(1);
-    }
-
-    // We'll store a "running" stabilized angles. Start from the input.
-    double stabilizedRoll  = roll_in;
-    double stabilizedPitch = pitch_in;
-    double stabilizedYaw   = 0.0;  // assume 0 for demonstration
-
-    Timer timer;
-    while (!timer.hasElapsedMilliseconds(TASK_BUSY_TIME))
-    {
-        // Convert degrees to radians
-        double radRoll  = stabilizedRoll  * M_PI / 180.0;
-        double radPitch = stabilizedPitch * M_PI / 180.0;
-
-        // Build rotationMatrix (rotation around Y by 'roll')
-        std::array<std::array<double,3>,3> rotationMatrix = {{
-            { std::cos(radRoll),  0.0, std::sin(radRoll) },
-            { 0.0,                1.0, 0.0               },
-            { -std::sin(radRoll), 0.0, std::cos(radRoll) }
-        }};
-
-        // Build correctionMatrix (rotation around X by 'pitch')
-        std::array<std::array<double,3>,3> correctionMatrix = {{
-            { 1.0,              0.0,               0.0 },
-            { 0.0,  std::cos(radPitch), -std::sin(radPitch) },
-            { 0.0,  std::sin(radPitch),  std::cos(radPitch) }
-        }};
-
-        // Multiply them to get resultMatrix
-        std::array<std::array<double,3>,3> resultMatrix = {{{0}}};
-        for (int i = 0; i < 3; ++i) {
-            for (int j = 0; j < 3; ++j) {
-                resultMatrix[i][j] = 0.0;
-                for (int k = 0; k < 3; k++) {
-                    resultMatrix[i][j] += rotationMatrix[i][k] * correctionMatrix[k][j];
-                }
-            }
-        }
-
-        // For demonstration, interpret each row's sum as new angles
-        // This ensures the matrix multiplication actually changes the output.
-        double row0 = resultMatrix[0][0] + resultMatrix[0][1] + resultMatrix[0][2];
-        double row1 = resultMatrix[1][0] + resultMatrix[1][1] + resultMatrix[1][2];
-        double row2 = resultMatrix[2][0] + resultMatrix[2][1] + resultMatrix[2][2];
-
-        // We'll treat row0 as the new "roll," row1 as "pitch," row2 as "yaw"
-        stabilizedRoll  = row0;
-        stabilizedPitch = row1;
-        stabilizedYaw   = row2;
-    }
-
-    Command sensorCommand = CORRECT_VECTOR;
-
-    // Send only what Task C needs: command, stabilizedRoll, stabilizedPitch, stabilizedYaw
-    snprintf(buffer, sizeof(buffer), "%d %.2f %.2f %.2f",
-             sensorCommand, stabilizedRoll, stabilizedPitch, stabilizedYaw);
-    BV_2->write_data(buffer);    
-
-    exit(0);
+    process_data(0);
 }
 
-void process_data_3(void) 
+void process_data_2(void)
 {
-#ifdef DEBUG
-    printf("task B-3\n");
-#endif
-
-    // Read from pipe AB_1
-    char buffer[64] = {0};
-    if (!AB_3->read_data(buffer, sizeof(buffer))) {                
-        exit(1);
-    }
-
-    if (strcmp(buffer, "1 12.60 -8.05" ))
-        exit(2);
-
-    int cmdInt = 0;
-    double roll_in=0.0, pitch_in=0.0;
-    int parsed = sscanf(buffer, "%d %lf %lf", &cmdInt, &roll_in, &pitch_in);
-    if (parsed != 3) {        
-        exit(1);
-    }
-
-    // We'll store a "running" stabilized angles. Start from the input.
-    double stabilizedRoll  = roll_in;
-    double stabilizedPitch = pitch_in;
-    double stabilizedYaw   = 0.0;  // assume 0 for demonstration
-
-    Timer timer;
-    while (!timer.hasElapsedMilliseconds(TASK_BUSY_TIME))
-    {
-        // Convert degrees to radians
-        double radRoll  = stabilizedRoll  * M_PI / 180.0;
-        double radPitch = stabilizedPitch * M_PI / 180.0;
-
-        // Build rotationMatrix (rotation around Y by 'roll')
-        std::array<std::array<double,3>,3> rotationMatrix = {{
-            { std::cos(radRoll),  0.0, std::sin(radRoll) },
-            { 0.0,                1.0, 0.0               },
-            { -std::sin(radRoll), 0.0, std::cos(radRoll) }
-        }};
-
-        // Build correctionMatrix (rotation around X by 'pitch')
-        std::array<std::array<double,3>,3> correctionMatrix = {{
-            { 1.0,              0.0,               0.0 },
-            { 0.0,  std::cos(radPitch), -std::sin(radPitch) },
-            { 0.0,  std::sin(radPitch),  std::cos(radPitch) }
-        }};
-
-        // Multiply them to get resultMatrix
-        std::array<std::array<double,3>,3> resultMatrix = {{{0}}};
-        for (int i = 0; i < 3; ++i) {
-            for (int j = 0; j < 3; ++j) {
-                resultMatrix[i][j] = 0.0;
-                for (int k = 0; k < 3; k++) {
-                    resultMatrix[i][j] += rotationMatrix[i][k] * correctionMatrix[k][j];
-                }
-            }
-        }
-
-        // For demonstration, interpret each row's sum as new angles
-        // This ensures the matrix multiplication actually changes the output.
-        double row0 = resultMatrix[0][0] + resultMatrix[0][1] + resultMatrix[0][2];
-        double row1 = resultMatrix[1][0] + resultMatrix[1][1] + resultMatrix[1][2];
-        double row2 = resultMatrix[2][0] + resultMatrix[2][1] + resultMatrix[2][2];
-
-        // We'll treat row0 as the new "roll," row1 as "pitch," row2 as "yaw"
-        stabilizedRoll  = row0;
-        stabilizedPitch = row1;
-        stabilizedYaw   = row2;
-    }
-
-    Command sensorCommand = CORRECT_VECTOR;
-
-    // Send only what Task C needs: command, stabilizedRoll, stabilizedPitch, stabilizedYaw
-    snprintf(buffer, sizeof(buffer), "%d %.2f %.2f %.2f",
-             sensorCommand, stabilizedRoll, stabilizedPitch, stabilizedYaw);
-    BV_3->write_data(buffer);    
+    process_data(1);
+}
 
-    exit(0);
+void process_data_3(void)
+{
+    process_data(2);
 }
 
+/**************************************
+ * Voter and task C, task C reads VC: the voter output, or the output of task B in the baseline
+ ************************************ */ 
 void majority_voter(void) {
 #ifdef DEBUG
     printf("Voter \n");
 #endif
 
-    char buffers[3][64] = {{0}};
+    attitude_message inputs[3];
     bool reads[3];
 
-    // 1) Read from each B->C pipe
-    reads[0] = BV_1->read_data(buffers[0], sizeof(buffers[0]));
-    reads[1] = BV_2->read_data(buffers[1], sizeof(buffers[1]));
-    reads[2] = BV_3->read_data(buffers[2], sizeof(buffers[2]));    
-
-    // 2) You could parse each buffer, compare the floats, do a majority vote
-    //    For now, let's do a simplistic "string compare" approach (like you do).
-    char outputBuffer[64] = {0};
-
-    if (reads[0] && reads[1] && strcmp(buffers[0], buffers[1]) == 0) {
-        strncpy(outputBuffer, buffers[0], sizeof(outputBuffer));
-    } else if (reads[0] && reads[2] && strcmp(buffers[0], buffers[2]) == 0) {
-        strncpy(outputBuffer, buffers[0], sizeof(outputBuffer));
-    } else if (reads[1] && reads[2] && strcmp(buffers[1], buffers[2]) == 0) {
-        strncpy(outputBuffer, buffers[1], sizeof(outputBuffer));
-    } else {
-        // If no two match, pick the first valid
-        if (reads[0]) strncpy(outputBuffer, buffers[0], sizeof(outputBuffer));
-        else if (reads[1]) strncpy(outputBuffer, buffers[1], sizeof(outputBuffer));
-        else if (reads[2]) strncpy(outputBuffer, buffers[2], sizeof(outputBuffer));
-        else exit(1); // no data
-    }
-
-    Timer timer;
-    while (!timer.hasElapsedMilliseconds(10)) { }
-
-    // 3) Write final result to next pipe (VC) for Task C    
-    VC->write_data(outputBuffer);
-    exit(0);
-}
-
-void control_actuators(void) 
-{
-#ifdef DEBUG
-    printf("Task C \n");
-#endif
-
-    char buffer[64] = {0};
-    if (!VC->read_data(buffer, sizeof(buffer))) {                
-        exit(1);
-    }
-
-    if (strcmp(buffer, "2 1.02 0.98 1.00" ))
-        exit(2);
+    // 1) Read the newest message from each B->C pipe
+    reads[0] = BV[0]->read_latest_message(inputs[0]);
+    reads[1] = BV[1]->read_latest_message(inputs[1]);
+    reads[2] = BV[2]->read_latest_message(inputs[2]);    
 
-    int cmdInt = 0;
-    double roll_in=0.0, pitch_in=0.0, yaw_in=0.0;
-    int parsed = sscanf(buffer, "%d %lf %lf %lf", &cmdInt, &roll_in, &pitch_in, &yaw_in);
-    if (parsed != 4) {
-        exit(1);
-    }    
-
-    // Busy loop to simulate PID
-    Timer timer;
-    double motorRollOutput=0.0, motorPitchOutput=0.0, motorYawOutput=0.0;
-    double Kp=0.8, Ki=0.1, Kd=0.2;
-    static double prevErrorRoll=0.0, integralRoll=0.0;
-    static double prevErrorPitch=0.0, integralPitch=0.0;
-    static double prevErrorYaw=0.0, integralYaw=0.0;
+    // Only the newest chain is voted on, a laggard of an earlier round may have left an older message
+    uint32_t chain = 0;
 
-    while (!timer.hasElapsedMilliseconds(TASK_BUSY_TIME))
+    for (int i = 0; i < 3; i++)
     {
-        // Let roll_in, pitch_in, yaw_in represent the "errors"
-        double errorRoll  = roll_in;
-        double errorPitch = pitch_in;
-        double errorYaw   = yaw_in;
-
-        // Basic PID for roll
-        integralRoll += errorRoll;
-        double derivativeRoll = (errorRoll - prevErrorRoll);
-        motorRollOutput = Kp * errorRoll + Ki * integralRoll + Kd * derivativeRoll;
-        prevErrorRoll   = errorRoll;
-
-        // Pitch
-        integralPitch += errorPitch;
-        double derivativePitch = (errorPitch - prevErrorPitch);
-        motorPitchOutput = Kp * errorPitch + Ki * integralPitch + Kd * derivativePitch;
-        prevErrorPitch   = errorPitch;
-
-        // Yaw
-        integralYaw += errorYaw;
-        double derivativeYaw = (errorYaw - prevErrorYaw);
-        motorYawOutput = Kp * errorYaw + Ki * integralYaw + Kd * derivativeYaw;
-        prevErrorYaw   = errorYaw;
+        if (reads[i] && inputs[i].header.chain > chain)
+            chain = inputs[i].header.chain;
     }
 
-    exit(0);
-}
-
-#else
-/**************************************
- * No NMR
- ************************************ */ 
-void read_sensors(void)
-{
-#ifdef DEBUG
-    printf("task A\n");
-#endif
-
-    // Simulated sensor values
-    double accelRoll     = 12.5;
-    double accelPitch    = -8.0;
-    double gyroRollRate  = 0.2;
-    double gyroPitchRate = -0.1;
-
-    // Complementary filter settings
-    double alpha           = 0.98;
-    double estimated_roll  = 0.0;
-    double estimated_pitch = 0.0;
-    
-
-    // Busy loop to simulate some processing time
-    Timer timer;
-    while (!timer.hasElapsedMilliseconds(TASK_BUSY_TIME))
+    for (int i = 0; i < 3; i++)
     {
-        // Apply complementary filter
-        estimated_roll  = alpha * (estimated_roll  + gyroRollRate  * 0.01)
-                        + (1 - alpha) * accelRoll;
-        estimated_pitch = alpha * (estimated_pitch + gyroPitchRate * 0.01)
-                        + (1 - alpha) * accelPitch;
-    }    
-
-    // Decide command based on thresholds
-    Command sensorCommand = CALCULATE_VECTOR;
-
-    // Send only what Task B needs: command, roll, pitch
-    char buffer[64];
-    snprintf(buffer, sizeof(buffer), "%d %.2f %.2f",
-             static_cast<int>(sensorCommand), estimated_roll, estimated_pitch);
-
-    AB->write_data(buffer);
-
-    exit(0);
-}
-
-void process_data(void)
-{
-#ifdef DEBUG
-    printf("task B-1\n");
-#endif
-
-    // Read from pipe AB_1
-    char buffer[64] = {0};
-    if (!AB->read_data(buffer, sizeof(buffer))) {        
-        exit(1);
+        if (reads[i] && inputs[i].header.chain != chain)
+            reads[i] = false;
     }
 
-    if (strcmp(buffer, "1 12.60 -8.05" ))
-        exit(2);
-
-#ifdef DEBUG
-    printf("Buffer: [%s] \n", buffer);
-#endif
-
-    int cmdInt = 0;
-    double roll_in=0.0, pitch_in=0.0;
-    int parsed = sscanf(buffer, "%d %lf %lf", &cmdInt, &roll_in, &pitch_in);
-    if (parsed != 3) {
-        //printf("DEBUG B: parse error, buffer=%s\n", buffer);
-        exit(1);
-    }    
-
-    // We'll store a "running" stabilized angles. Start from the input.
-    double stabilizedRoll  = roll_in;
-    double stabilizedPitch = pitch_in;
-    double stabilizedYaw   = 0.0;  // assume 0 for demonstration
-
-    Timer timer;
-    while (!timer.hasElapsedMilliseconds(TASK_BUSY_TIME))
-    {
-        // Convert degrees to radians
-        double radRoll  = stabilizedRoll  * M_PI / 180.0;
-        double radPitch = stabilizedPitch * M_PI / 180.0;
-
-        // Build rotationMatrix (rotation around Y by 'roll')
-        std::array<std::array<double,3>,3> rotationMatrix = {{
-            { std::cos(radRoll),  0.0, std::sin(radRoll) },
-            { 0.0,                1.0, 0.0               },
-            { -std::sin(radRoll), 0.0, std::cos(radRoll) }
-        }};
+    // 2) Majority vote, two matching replicates win
+    attitude_message output;
 
-        // Build correctionMatrix (rotation around X by 'pitch')
-        std::array<std::array<double,3>,3> correctionMatrix = {{
-            { 1.0,              0.0,               0.0 },
-            { 0.0,  std::cos(radPitch), -std::sin(radPitch) },
-            { 0.0,  std::sin(radPitch),  std::cos(radPitch) }
-        }};
-
-        // Multiply them to get resultMatrix
-        std::array<std::array<double,3>,3> resultMatrix = {{{0}}};
-        for (int i = 0; i < 3; ++i) {
-            for (int j = 0; j < 3; ++j) {
-                resultMatrix[i][j] = 0.0;
-                for (int k = 0; k < 3; k++) {
-                    resultMatrix[i][j] += rotationMatrix[i][k] * correctionMatrix[k][j];
-                }
-            }
-        }
-
-        // For demonstration, interpret each row's sum as new angles
-        // This ensures the matrix multiplication actually changes the output.
-        double row0 = resultMatrix[0][0] + resultMatrix[0][1] + resultMatrix[0][2];
-        double row1 = resultMatrix[1][0] + resultMatrix[1][1] + resultMatrix[1][2];
-        double row2 = resultMatrix[2][0] + resultMatrix[2][1] + resultMatrix[2][2];
-
-        // We'll treat row0 as the new "roll," row1 as "pitch," row2 as "yaw"
-        stabilizedRoll  = row0;
-        stabilizedPitch = row1;
-        stabilizedYaw   = row2;
+    if (reads[0] && reads[1] && attitude_equal(inputs[0], inputs[1])) {
+        output = inputs[0];
+    } else if (reads[0] && reads[2] && attitude_equal(inputs[0], inputs[2])) {
+        output = inputs[0];
+    } else if (reads[1] && reads[2] && attitude_equal(inputs[1], inputs[2])) {
+        output = inputs[1];
+    } else {
+        // If no two match, pick the first valid
+        if (reads[0]) output = inputs[0];
+        else if (reads[1]) output = inputs[1];
+        else if (reads[2]) output = inputs[2];
+        else task_exit(1); // no data
     }
 
-    Command sensorCommand = CORRECT_VECTOR;
-
-    // Send only what Task C needs: command, stabilizedRoll, stabilizedPitch, stabilizedYaw
-    snprintf(buffer, sizeof(buffer), "%d %.2f %.2f %.2f",
-             sensorCommand, stabilizedRoll, stabilizedPitch, stabilizedYaw);
-    BC->write_data(buffer);    
+    Timer timer;
+    while (!timer.hasElapsedMilliseconds(10)) { }
 
-    exit(0);
+    // 3) Write final result to next pipe (VC) for Task C, it keeps the chain and path of the winning replicate
+    VC->write_message(output);
+    task_exit(0);
 }
 
 void control_actuators(void) 
@@ -554,20 +235,17 @@ void control_actuators(void)
     printf("Task C \n");
 #endif
 
-    char buffer[64] = {0};
-    if (!BC->read_data(buffer, sizeof(buffer))) {                
-        exit(1);
+    attitude_message in;
+    if (!VC->read_message(in)) {
+        task_exit(1);
     }
 
-    if (strcmp(buffer, "2 1.02 0.98 1.00" ))
-        exit(2);
+    if (!attitude_expected(in))
+        task_exit(2);
 
-    int cmdInt = 0;
-    double roll_in=0.0, pitch_in=0.0, yaw_in=0.0;
-    int parsed = sscanf(buffer, "%d %lf %lf %lf", &cmdInt, &roll_in, &pitch_in, &yaw_in);
-    if (parsed != 4) {
-        exit(1);
-    }    
+    E2E->record(in.header);
+
+    double roll_in = in.roll, pitch_in = in.pitch, yaw_in = in.yaw;
 
     // Busy loop to simulate PID
     Timer timer;
@@ -577,7 +255,7 @@ void control_actuators(void)
     static double prevErrorPitch=0.0, integralPitch=0.0;
     static double prevErrorYaw=0.0, integralYaw=0.0;
 
-    while (!timer.hasElapsedMilliseconds(TASK_BUSY_TIME))
+    while (!timer.hasElapsedMilliseconds(CONFIG.busy_time))
     {
         // Let roll_in, pitch_in, yaw_in represent the "errors"
         double errorRoll  = roll_in;
@@ -603,7 +281,6 @@ void control_actuators(void)
         prevErrorYaw   = errorYaw;
     }
 
-    exit(0);
+    task_exit(0);
 }
 
-#endif
\ No newline at end of file
@@ -0,0 +1,34 @@
+#include <math.h>
+
+#include <flight_controller.h>
+
+#define MESSAGE_PRECISION 0.005
+
+static bool matches(double value, double expected)
+{
+    return fabs(value - expected) < MESSAGE_PRECISION;
+}
+
+bool sensor_expected(const sensor_message &msg)
+{
+    return msg.command == CALCULATE_VECTOR && matches(msg.roll, 12.60) && matches(msg.pitch, -8.05);
+}
+
+bool attitude_expected(const attitude_message &msg)
+{
+    return msg.command == CORRECT_VECTOR && matches(msg.roll, 1.02) && matches(msg.pitch, 0.98) && matches(msg.yaw, 1.00);
+}
+
+bool attitude_equal(const attitude_message &lhs, const attitude_message &rhs)
+{
+    return lhs.command == rhs.command && 
+           matches(lhs.roll, rhs.roll) && matches(lhs.pitch, rhs.pitch) && matches(lhs.yaw, rhs.yaw);
+}
+
+uint64_t attitude_digest(const attitude_message &msg)
+{
+    // The values are rounded to steps of the compare precision
+    int64_t values[4] = { msg.command, llround(msg.roll / MESSAGE_PRECISION), llround(msg.pitch / MESSAGE_PRECISION), llround(msg.yaw / MESSAGE_PRECISION) };
+
+    return message_checksum(values, sizeof(values));
+}
@@ -0,0 +1,131 @@
+/**
+ * @file channel.h
+ * @brief This file contains a shared memory channel that can be used instead of a Pipe.
+ *
+ * A Channel is a lock-free single-producer/single-consumer ring in a memfd backed MAP_SHARED
+ * mapping. It is created before the tasks are forked, so the producer and consumer processes
+ * exchange messages through memory only: no syscalls and no copies through the kernel. The head
+ * and tail live on their own cache line and every slot carries the sequence number of its message.
+ *
+ * If EVENT_DRIVEN is defined, the producer additionally signals an eventfd after publishing a
+ * message, so the scheduler can sleep on the channel like it does on the read end of a pipe.
+ */
+
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#include "defines.h"
+#include "message.h"
+
+typedef struct channel_slot {
+    std::atomic<uint64_t> sequence;         // Sequence number of the message in this slot (1 based)
+    uint32_t size;
+    char data[CHANNEL_SLOT_SIZE];
+} channel_slot;
+
+typedef struct channel_ring {
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head;   // Messages written, only stored by the producer
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail;   // Messages read, only stored by the consumer
+    alignas(CACHE_LINE_SIZE) channel_slot slots[CHANNEL_SLOTS];
+} channel_ring;
+
+class Channel {
+    private:
+        channel_ring *m_ring { NULL };
+        int m_notify_fd { -1 };             // eventfd signalled on every write, -1 if not EVENT_DRIVEN
+        char *m_name;
+        int m_tokens { 0 };                 // Messages in flight if SIMULATION is defined
+
+    public:
+        Channel(channel_ring *ring, int notify_fd, const char *name);
+
+        /**
+         * @brief Creates a new shared memory channel and returns a Channel object.
+         *
+         * @param name Name of the channel.
+         * @return Pointer to the created Channel object.
+         *
+         * Exits the program if the shared memory cannot be created or mapped.
+         */
+        static Channel* declare_channel(const char *name);
+
+        /**
+         * @brief Reads the oldest message from the channel into a buffer.
+         *
+         * @param buffer Buffer to store the read data.
+         * @param buf_size Size of the buffer.
+         * @return true if a message was read; false if the channel is empty.
+         */
+        bool read_data(char *buffer, size_t buf_size);
+
+        /**
+         * @brief Writes a null-terminated message to the channel.
+         *
+         * @param buffer Buffer containing the data to write.
+         * @return true if the message was written; false if the channel is full or the message does not fit a slot.
+         */
+        bool write_data(const char *buffer);
+
+        /**
+         * @brief Reads the oldest message as raw bytes.
+         *
+         * @param buffer Buffer to store the message.
+         * @param size Size of the buffer, larger messages are truncated.
+         * @return The size of the message, 0 if the channel is empty.
+         */
+        size_t read_raw(void *buffer, size_t size);
+
+        /**
+         * @brief Writes raw bytes as one message.
+         *
+         * @param buffer The data to write.
+         * @param size The number of bytes, at most CHANNEL_SLOT_SIZE.
+         * @return true if the message was written; false otherwise.
+         */
+        bool write_raw(const void *buffer, size_t size);
+
+        /**
+         * @brief Seals and writes a typed message (see message.h).
+         */
+        template <typename T>
+        bool write_message(T &msg)
+        {
+            message_seal(msg);
+            return write_raw(&msg, sizeof(T));
+        }
+
+        /**
+         * @brief Reads a typed message and validates its header and checksum.
+         */
+        template <typename T>
+        bool read_message(T &msg)
+        {
+            return read_raw(&msg, sizeof(T)) == sizeof(T) && message_valid(msg);
+        }
+
+        /**
+         * @brief Checks whether a message can be read, without any syscall.
+         */
+        bool readable() { return m_ring->head.load(std::memory_order_acquire) != m_ring->tail.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Returns the number of unread messages.
+         */
+        uint64_t pending() { return m_ring->head.load(std::memory_order_acquire) - m_ring->tail.load(std::memory_order_acquire); }
+
+        int get_notify_fd() { return m_notify_fd; }
+        const char* get_name() { return m_name; }
+
+        /**
+         * @brief Counts simulated messages, a simulated task consumes and produces tokens instead of data.
+         */
+        int get_tokens() { return m_tokens; }
+        void add_token() { m_tokens++; }
+        void take_token() { if (m_tokens) m_tokens--; }
+};
+
+#endif
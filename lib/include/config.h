@@ -0,0 +1,105 @@
+/**
+ * @file config.h
+ * @brief This file contains the run parameters that can be changed without a rebuild.
+ *
+ * The defaults are the defines in defines.h. A run overrides them with `--key value` arguments or with
+ * a file of `key = value` lines (`--config <file>`), the arguments are applied in order. The parameters
+ * live in the global CONFIG, which the scheduler, the cores and the tasks read.
+ *
+ * The cores of a run are pinned to the CPUs cpu_base, cpu_base + 1, ... and the scheduler to CPU
+ * cpu_base + scheduler_core, so runs with a different cpu_base can share a machine (see tools/src/sweep.cpp).
+ *
+ * The redundancy mode picks the task graph of the run: baseline, NMR or RAV-NMR. NMR or RAVNMR in
+ * defines.h only sets the default, a list of modes (`--mode baseline,nmr,ravnmr` or `--mode all`) runs
+ * the graphs back to back in one process.
+ */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "defines.h"
+
+using namespace std;
+
+enum class redundancy_mode {
+    baseline,                                   // A -> B -> C
+    nmr,                                        // Three replicates of B and a standard voter
+    ravnmr                                      // Three replicates of B and a weighted voter
+};
+
+#if defined(RAVNMR)
+#define DEFAULT_MODE redundancy_mode::ravnmr
+#elif defined(NMR)
+#define DEFAULT_MODE redundancy_mode::nmr
+#else
+#define DEFAULT_MODE redundancy_mode::baseline
+#endif
+
+typedef struct run_config {
+    int cores { NUM_OF_CORES };                 // Number of cores that run tasks, at most MAX_CORES
+    int scheduler_core { SCHEDULER_CORE };      // The core the scheduler runs on, no tasks run on it
+    int cpu_base { 0 };                         // The CPU of core 0
+    int buffer_size { CORE_BUFFER_SIZE };       // Number of results the weight of a core is averaged over
+    int stuck_time { MAX_STUCK_TIME };          // Max time (in milliseconds) a task may stay in the same state
+    int busy_time { TASK_BUSY_TIME };           // The time (in milliseconds) a task is busy
+    long iterations { MAX_ITERATIONS };         // Runs of the first task if ITERATION_BASED is defined
+    long run_time { MAX_RUN_TIME };             // Run time (in milliseconds) if TIME_BASED is defined
+    string results;                             // The result directory, a timestamped directory in results/ if empty
+    vector<redundancy_mode> modes { DEFAULT_MODE }; // The redundancy modes, run one after the other
+    string graph;                               // A graph file to run instead of the modes (see graph.h), none if empty
+
+    /**
+     * @brief Returns the number of CPUs the run is pinned to: the cores and the scheduler core.
+     */
+    int get_width() const { return (cores > scheduler_core) ? cores : scheduler_core + 1; }
+} run_config;
+
+extern run_config CONFIG;
+
+/**
+ * @brief Returns the name of a redundancy mode, also the name of its scheduler: baseline, NMR or RAV-NMR.
+ */
+const char* mode_name(redundancy_mode mode);
+
+/**
+ * @brief Sets one parameter.
+ *
+ * @param config The parameters.
+ * @param key The name of the parameter, '-' and '_' are interchangeable.
+ * @param value The value.
+ * @return true if the key exists and the value is valid; false otherwise.
+ */
+bool config_set(run_config &config, const string &key, const string &value);
+
+/**
+ * @brief Applies the `key = value` lines of a file, empty lines and lines starting with # are skipped.
+ *
+ * @param config The parameters.
+ * @param path The path of the file.
+ * @return true if every line was applied; false otherwise.
+ */
+bool config_load(run_config &config, const string &path);
+
+/**
+ * @brief Applies the `--key value` and `--config <file>` arguments of a program.
+ *
+ * @param config The parameters.
+ * @param argc The number of arguments.
+ * @param argv The arguments, argv[0] is skipped.
+ * @return true if every argument was applied; false otherwise, the error is printed.
+ */
+bool config_parse(run_config &config, int argc, char *argv[]);
+
+/**
+ * @brief Prints the parameters and their values as `--key value` usage lines.
+ *
+ * @param file The stream to print to.
+ * @param config The parameters.
+ */
+void config_usage(FILE *file, const run_config &config);
+
+#endif
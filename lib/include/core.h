@@ -2,10 +2,16 @@
 #define CORE_H
 
 #include "defines.h"
+#include "counters.h"
+#include "usage.h"
+#include "config.h"
+#include <stddef.h>
 #include <queue>
 
 using namespace std;
 
+class core_index;
+
 class core {
     private:
         int m_coreID;
@@ -13,6 +19,9 @@ class core {
         bool m_active;
         int m_runs;   
         queue<int> m_scoreBuffer;
+        core_index *m_index { NULL };   // Notified when the activity, runs or weight change
+        counter_totals m_counters {};   // Summed counters of the jobs that ran on this core (if PERF_COUNTERS is defined)
+        usage_totals m_usage {};        // Summed resource usage of the jobs that ran on this core
 
     public:
         core(int id, float weight, bool active, int runs);
@@ -21,7 +30,7 @@ class core {
         void set_coreID(int coreID) { m_coreID = coreID; }
 
         float get_weight() { return m_weight; }
-        void set_weight(float weight) { m_weight = weight; }
+        void set_weight(float weight);
 
         void update_weight(int result);
         
@@ -29,11 +38,19 @@ class core {
         // void decrease_weight(bool result);
 
         bool get_active() { return m_active; }
-        void set_active(bool active) { m_active = active; }
+        void set_active(bool active);
 
         int get_runs() { return m_runs; }
-        void set_runs(int runs) { m_runs = runs; }
-        void increase_runs() { m_runs++; }
+        void set_runs(int runs);
+        void increase_runs();
+
+        void set_index(core_index *index) { m_index = index; }
+
+        const counter_totals& get_counters() { return m_counters; }
+        void add_job_counters(const counter_totals &job) { add_counters(m_counters, job); }
+
+        const usage_totals& get_usage() { return m_usage; }
+        void add_job_usage(const job_usage &job) { add_usage(m_usage, job); }
 };
 
 #endif
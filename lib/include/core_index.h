@@ -0,0 +1,83 @@
+/**
+ * @file core_index.h
+ * @brief This file contains the indexed heaps used by the scheduler to select a free core in O(log n).
+ *
+ * The core_index keeps every inactive core in two indexed binary heaps: one ordered on runs for
+ * normal tasks, and one ordered on (weight, runs) for weighted voters. Cores notify the index
+ * whenever their activity, runs or weight change, so finding a core only reads the top of a heap.
+ * Ties are broken on the core ID, which gives the same placement as a linear scan over the cores.
+ */
+
+#ifndef CORE_INDEX_H
+#define CORE_INDEX_H
+
+#include <stddef.h>
+#include <vector>
+
+#include "defines.h"
+
+using namespace std;
+
+class core;
+
+class core_heap {
+    private:
+        vector<core*> m_heap;
+        vector<int> m_position;                 // Position of each core ID in m_heap, -1 if absent
+        bool (*m_before)(core *lhs, core *rhs);
+
+        void swap_nodes(int a, int b);
+        void sift_up(int i);
+        void sift_down(int i);
+
+    public:
+        core_heap(bool (*before)(core *lhs, core *rhs));
+
+        /**
+         * @brief Inserts, removes or repositions a core.
+         *
+         * @param c The core that changed.
+         * @param present Whether the core should be in the heap.
+         */
+        void update(core *c, bool present);
+
+        /**
+         * @brief Returns the first core in heap order, NULL if the heap is empty.
+         */
+        core* top() { return m_heap.empty() ? NULL : m_heap.front(); }
+};
+
+class core_index {
+    private:
+        core_heap m_byRuns;
+        core_heap m_byWeight;
+
+    public:
+        core_index();
+
+        /**
+         * @brief Attaches a core to the index, the core reports its changes from now on.
+         *
+         * @param c The core to add.
+         */
+        void add_core(core *c);
+
+        /**
+         * @brief Repositions a core after its activity, runs or weight changed.
+         *
+         * @param c The core that changed.
+         */
+        void update(core *c);
+
+        /**
+         * @brief Returns the inactive core with the fewest runs, NULL if all cores are active.
+         */
+        core* least_runs() { return m_byRuns.top(); }
+
+        /**
+         * @brief Returns the inactive core with the highest weight (fewest runs on a tie), NULL if all cores are active.
+         */
+        core* most_reliable() { return m_byWeight.top(); }
+};
+
+#endif
@@ -0,0 +1,92 @@
+/**
+ * @file counters.h
+ * @brief This file contains the per-job performance counters (if PERF_COUNTERS is defined).
+ *
+ * The scheduler opens a perf_event_open group on every job it starts and reads it with a single read()
+ * when the job completes. The group counts cycles, instructions, last level cache misses and branch
+ * misses (hardware events), plus context switches and the task clock (software events). If the hardware
+ * events are not supported, e.g. in a virtual machine, the first job finds out and all jobs count the
+ * software events only. If perf_event_open is not available at all, no counters are opened.
+ */
+
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+enum counter_id {
+    counter_cycles,
+    counter_instructions,
+    counter_llc_misses,
+    counter_branch_misses,
+    counter_context_switches,
+    counter_task_clock,                     // In nanoseconds
+    NUM_COUNTERS,
+};
+
+enum counter_support {
+    counters_unknown,                       // No job was counted yet
+    counters_hardware,
+    counters_software,                      // Only the software events can be opened
+    counters_none,
+};
+
+extern const char *counter_names[NUM_COUNTERS];
+
+/**
+ * @brief Sums of the counters of the jobs of a task or core.
+ */
+typedef struct counter_totals {
+    uint64_t jobs;
+    uint64_t value[NUM_COUNTERS];
+} counter_totals;
+
+class perf_counters {
+    private:
+        int m_fds[NUM_COUNTERS];
+        int m_order[NUM_COUNTERS];          // The counter of each value in a group read
+        int m_open { 0 };
+
+        static counter_support s_support;
+        static bool s_excludeKernel;
+
+        int open_event(int counter, pid_t pid, int group);
+
+    public:
+        perf_counters();
+        ~perf_counters() { close(); }
+
+        /**
+         * @brief Starts counting a job.
+         *
+         * @param pid The process that runs the job, it is counted from now on.
+         * @return true if the counters were opened; false if they are not available.
+         */
+        bool open(pid_t pid);
+
+        /**
+         * @brief Reads the counters of the job and closes them.
+         *
+         * @param job Set to the counts of the job (jobs is 1), the counters that are not supported are 0.
+         * @return true if the counters were read; false if none were open.
+         */
+        bool read(counter_totals &job);
+
+        /**
+         * @brief Closes the counters without reading them.
+         */
+        void close();
+
+        /**
+         * @brief Returns which counters could be opened so far.
+         */
+        static counter_support get_support() { return s_support; }
+};
+
+/**
+ * @brief Adds the counts of one job to the totals of a task or core.
+ */
+void add_counters(counter_totals &totals, const counter_totals &job);
+
+#endif
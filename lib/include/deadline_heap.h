@@ -0,0 +1,73 @@
+/**
+ * @file deadline_heap.h
+ * @brief This file contains the min-heap of absolute task deadlines used by the scheduler.
+ *
+ * Every task has at most one pending deadline of each type: its next period release, the expiry
+ * of its startup offset and, while it runs, its stuck timeout. The scheduler pops the expired
+ * entries each pass and only touches the tasks they belong to, instead of checking the time
+ * conditions of every task. If SIMULATION is defined, the completion of each simulated run is a
+ * deadline as well. Entries that became obsolete (e.g. the stuck timeout of a job that
+ * already completed) are not removed but discarded when popped, based on their generation.
+ */
+
+#ifndef DEADLINE_HEAP_H
+#define DEADLINE_HEAP_H
+
+#include <vector>
+
+using namespace std;
+
+class task;
+
+enum deadline_type {
+    deadline_release,
+    deadline_offset,
+    deadline_stuck,
+    deadline_completion,
+};
+
+typedef struct deadline_entry {
+    unsigned long int time;     // Absolute deadline in milliseconds
+    task *t;
+    deadline_type type;
+    int generation;             // The run of the task the deadline belongs to
+} deadline_entry;
+
+class deadline_heap {
+    private:
+        vector<deadline_entry> m_heap;
+
+    public:
+        /**
+         * @brief Reserves room for the given number of entries, so pushing does not allocate.
+         */
+        void reserve(size_t entries) { m_heap.reserve(entries); }
+
+        /**
+         * @brief Adds a deadline to the heap in O(log n).
+         *
+         * @param time Absolute deadline in milliseconds.
+         * @param t The task the deadline belongs to.
+         * @param type The type of the deadline.
+         * @param generation The run of the task the deadline belongs to.
+         */
+        void push(unsigned long int time, task *t, deadline_type type, int generation);
+
+        /**
+         * @brief Removes the earliest deadline if it has expired.
+         *
+         * @param currentTime The current time in milliseconds.
+         * @param entry Set to the expired entry.
+         * @return true if an expired entry was popped, false otherwise.
+         */
+        bool pop_expired(unsigned long int currentTime, deadline_entry &entry);
+
+        /**
+         * @brief Returns the earliest deadline, 0 if the heap is empty.
+         */
+        unsigned long int next_deadline() { return m_heap.empty() ? 0 : m_heap.front().time; }
+
+        size_t size() { return m_heap.size(); }
+};
+
+#endif
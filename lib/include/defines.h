@@ -11,17 +11,64 @@
 #define MAX_STUCK_TIME 500                  // Max time (in milliseconds) a task may stay in the same state 
 
 /* Scheduler related defines */
-#define NUM_OF_CORES 4                      // Num of cores used by the scheduler
+#define NUM_OF_CORES 4                      // Num of cores used by the scheduler, the default of --cores (see config.h)
 #define SCHEDULER_CORE  4                   // The core ID on which the scheduler runs, no other tasks will run on this core
+#define MAX_CORES 64                        // Max number of cores a run can be configured with (see config.h)
 #define MAX_CORE_WEIGHT 100.0               // Max (and start) reliability weight of a core
+#define MIN_VOTER_CORE_WEIGHT 80            // Min weight of the core a weighted voter runs on
 #define CORE_BUFFER_SIZE 4                  // Size of the buffer used in the pipes, 4 bytes for integer values
+#define EVENT_DRIVEN                        // Sleep on epoll (pidfd/timerfd/pipes) instead of polling every millisecond
+#define MAX_EPOLL_EVENTS 64                 // Max number of events handled per epoll_wait call
+#define CHANNEL_SLOTS 16                    // Number of messages a shared memory channel can buffer
+#define CHANNEL_SLOT_SIZE 120               // Max size (in bytes) of a message in a shared memory channel
+#define CACHE_LINE_SIZE 64                  // Alignment of the head and tail of a shared memory channel
+//#define WORKER_POOL                       // Run jobs on a persistent worker process per core instead of forking each job
+//#define SIMULATION                        // Run the task model on a virtual clock with sampled costs instead of forking the tasks
+#define SIM_SEED 1                          // Seed of the cost and fault sampling if SIMULATION is defined
+#define SIM_JITTER 5                        // Max deviation (in milliseconds) of a simulated replicate from TASK_BUSY_TIME
+#define SIM_FAULT_RATE 0.0                  // Probability that a simulated replicate fails
 
 /* Log related defines*/
 //#define DEBUG                             // Has each task print its name when it runs
 #define LOGGING                             // Log the parameters (core weight & core/task utility)
 #define MAX_LOG_INTERVAL    10              // Number of miliseconds between each log 
+#define MAX_LOG_SAMPLES 262144              // Number of samples kept in memory, the oldest samples are overwritten when full
+#define MAX_LOG_BYTES (64 << 20)            // Max memory (in bytes) of the samples kept in memory, fewer samples are kept when there are many tasks
+#define MAX_LOGGED_TASKS 256                // Max number of tasks sampled when a graph file is run, the first tasks of the file are sampled
+//#define ASYNC_LOGGING                     // Stream the samples to the result files from a writer thread instead of keeping them in memory
+//#define LOG_BINARY                        // Have the writer thread write the compact trace.bin instead of the .tsv files (needs ASYNC_LOGGING)
+#define LOG_RING_SLOTS 8192                 // Number of samples buffered between the scheduler and the writer thread
+#define LOG_WRITER_PERIOD 10                // Time (in milliseconds) the writer thread sleeps when there is nothing to write
+#define LATENCY_PRECISION_BITS 6            // The latency histograms split every power of two in 2^(n-1) buckets, max error 2^-(n-1)
+#define LATENCY_RANGE_BITS 40               // Latencies (in nanoseconds) up to 2^n are kept apart, about 18 minutes
+#define MAX_E2E_PATHS 8                     // Max number of end-to-end (sensor to actuator) paths that are tracked
+//#define PERF_COUNTERS                     // Count the cycles, instructions, cache and branch misses and context switches of every job
+//#define EVENT_TRACE                       // Record every release, dispatch, completion and vote and export them to trace.json (Chrome trace format)
+#define EVENT_TRACE_SLOTS 262144            // Number of events kept if EVENT_TRACE is defined, the oldest events are overwritten when full
 
-//#define NMR
-//#define RAVNMR
+//#define NMR                              // Run NMR by default, --mode overrides it (see config.h)
+//#define RAVNMR                            // Run RAV-NMR by default, --mode overrides it
+//#define VOTER_QUORUM 2                    // Fire the voter once this many replicates succeeded with the same output instead of waiting for all of them
+//#define CANCEL_LAGGARDS                   // Kill the replicates that are still running when the voter fires (needs VOTER_QUORUM)
+
+/* Workload generator related defines, used by the scaling experiments (bin/scaling) */
+#define WORKLOAD_SEED 1                     // Seed of the generated task graphs
+//#define WORKLOAD_RANDOM                   // Generate random DAGs instead of layered graphs
+#define WORKLOAD_LAYERS 8                   // Number of layers, the first layer holds the periodic sources
+#define WORKLOAD_MAX_FAN_IN 3               // Max number of inputs of a stage
+#define WORKLOAD_MAX_FAN_OUT 4              // Max number of stages a stage feeds
+#define WORKLOAD_PERIODS { 50, 100, 200 }   // The periods (in milliseconds) the sources pick from
+#define WORKLOAD_REPLICAS 3                 // Number of replicates of a replicated stage
+#define WORKLOAD_REPLICATED 0.1             // Share of the non-source stages that is replicated and voted
+#define WORKLOAD_COST_MEAN 2                // Mean execution time (in milliseconds) of a generated task
+#define WORKLOAD_COST_JITTER 1              // Max deviation (in milliseconds) from WORKLOAD_COST_MEAN
+#define WORKLOAD_FAULT_RATE 0.0             // Probability that a generated task fails
+#define WORKLOAD_RUN_TIME 10000             // Time (in milliseconds, virtual if SIMULATION is defined) each graph runs
+
+/* The simulation does not fork, so there are no children or workers to wait for */
+#ifdef SIMULATION
+#undef EVENT_DRIVEN
+#undef WORKER_POOL
+#endif
 
 #endif
\ No newline at end of file
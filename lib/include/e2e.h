@@ -0,0 +1,88 @@
+/**
+ * @file e2e.h
+ * @brief This file contains the end-to-end latency tracker of the sensor-to-actuator chains.
+ *
+ * The source task stamps every sample it sends with message_originate(), the tasks in between copy
+ * the stamp of their input with message_forward() and tag the path the data takes (e.g. the replicate
+ * that computed it). The sink records the age of the data it consumes per path. The tracker lives in a
+ * MAP_SHARED mapping that is created before the tasks are forked, so the tasks record directly into
+ * the histograms the scheduler reports. Only one task records per path at a time.
+ */
+
+#ifndef E2E_H
+#define E2E_H
+
+#include <stdint.h>
+#include <atomic>
+
+#include "defines.h"
+#include "histogram.h"
+#include "message.h"
+
+#define E2E_NAME_SIZE 32
+
+typedef struct e2e_path {
+    char name[E2E_NAME_SIZE];
+    latency_histogram latency;              // Age (in nanoseconds) of the data when it was consumed
+} e2e_path;
+
+typedef struct e2e_shared {
+    std::atomic<uint32_t> next_chain;       // Chain ID of the next source sample
+    std::atomic<uint32_t> last_chain;       // Latest chain consumed by a sink
+    std::atomic<uint64_t> lost;             // Chains that never reached a sink
+    std::atomic<uint64_t> repeated;         // Chains consumed more than once
+    uint32_t paths;
+    e2e_path path[MAX_E2E_PATHS];
+} e2e_shared;
+
+class e2e_tracker {
+    private:
+        e2e_shared *m_shared;
+
+    public:
+        e2e_tracker(e2e_shared *shared);
+
+        /**
+         * @brief Unmaps the shared memory, call after the jobs that record into it have ended.
+         */
+        ~e2e_tracker();
+
+        /**
+         * @brief Creates a tracker in shared memory, call before the tasks are forked.
+         *
+         * @return Pointer to the created tracker.
+         *
+         * Exits the program if the shared memory cannot be mapped.
+         */
+        static e2e_tracker* declare_e2e_tracker();
+
+        /**
+         * @brief Registers a path, call before the tasks are forked.
+         *
+         * @param name The name of the path, e.g. "A->B->C".
+         * @return The ID to pass to message_forward().
+         *
+         * Exits the program if more than MAX_E2E_PATHS paths are added.
+         */
+        uint32_t add_path(const char *name);
+
+        /**
+         * @brief Returns the chain ID of a new source sample.
+         */
+        uint32_t next_chain() { return m_shared->next_chain.fetch_add(1, std::memory_order_relaxed) + 1; }
+
+        /**
+         * @brief Records the end-to-end latency of a consumed message.
+         *
+         * @param header The header of the message, untracked messages and unknown paths are ignored.
+         */
+        void record(const message_header &header);
+
+        uint32_t get_paths() { return m_shared->paths; }
+        const char* get_name(uint32_t path) { return m_shared->path[path - 1].name; }
+        const latency_histogram& get_latency(uint32_t path) { return m_shared->path[path - 1].latency; }
+        uint64_t get_lost() { return m_shared->lost.load(std::memory_order_relaxed); }
+        uint64_t get_repeated() { return m_shared->repeated.load(std::memory_order_relaxed); }
+};
+
+#endif
@@ -0,0 +1,133 @@
+/**
+ * @file event_loop.h
+ * @brief This file contains the epoll based event loop used by the event driven scheduler.
+ *
+ * Child completions (pidfd, or signalfd on SIGCHLD as a fallback), pipe readiness and the
+ * next period/offset/stuck/log deadline (timerfd) are all delivered through a single epoll
+ * instance, so the scheduler only wakes up when something actually happened.
+ *
+ * Every input of every task is registered once. A readiness event sets the bit of its input in
+ * the input_table of the task, so checking the inputs of a task takes no syscalls and works for
+ * any number of descriptors. A scheduler that polls uses an epoll instance for the inputs only.
+ */
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <sys/types.h>
+#include <sys/epoll.h>
+#include <vector>
+
+#include "defines.h"
+
+enum event_type {
+    child_exit,
+    input_ready,
+    worker_status,
+    deadline,
+    child_signal,
+};
+
+typedef struct event_source {
+    event_type type;
+    void *owner;
+    int index { 0 };                        // The input of an input_ready source, the owner is its input_table
+} event_source;
+
+class event_loop {
+    private:
+        int m_epoll_fd { -1 };
+        int m_timer_fd { -1 };
+        int m_signal_fd { -1 };
+        bool m_pidfd_supported { false };
+        long m_armedDeadline { 0 };
+
+        event_source m_timerSource { deadline, NULL };
+        event_source m_signalSource { child_signal, NULL };
+
+        struct epoll_event m_events[MAX_EPOLL_EVENTS];
+        std::vector<int> m_filledInputs;    // The owners of the input tables that became full, see wait()
+
+        void init_epoll();
+
+    public:
+        event_loop();
+        ~event_loop();
+
+        static event_loop* declare_event_loop();
+
+        /**
+         * @brief Creates an epoll instance that only tracks the readiness of inputs, without timer or child events.
+         *
+         * Used by a scheduler that polls (EVENT_DRIVEN not defined). Exits the program if it cannot be created.
+         */
+        static event_loop* declare_readiness_set();
+
+        /**
+         * @brief Creates the epoll instance and the deadline timer.
+         *
+         * Checks whether the kernel supports pidfd_open. If it does not, SIGCHLD is blocked and
+         * routed through a signalfd instead so child completions still wake up the loop.
+         * Exits the program if one of the file descriptors cannot be created.
+         */
+        void init();
+
+        /**
+         * @brief Registers a forked child so its termination wakes up the loop.
+         *
+         * @param pid The process ID of the child.
+         * @param src The event source reported when the child exits.
+         * @param edge Use edge triggered notification, for children that are not reaped right away.
+         * @return The pidfd of the child, or -1 if completions are reported through the signalfd.
+         */
+        int watch_child(pid_t pid, event_source *src, bool edge = false);
+
+        /**
+         * @brief Registers a file descriptor (e.g. the read end of a pipe) for readability.
+         *
+         * @param fd The file descriptor to watch.
+         * @param src The event source reported when the descriptor becomes readable.
+         * @param edge Use edge triggered notification, so unread data does not keep the loop awake.
+         */
+        void watch_fd(int fd, event_source *src, bool edge);
+
+        /**
+         * @brief Removes a file descriptor from the epoll set and closes it.
+         *
+         * @param fd The file descriptor to remove, ignored when negative.
+         */
+        void unwatch_fd(int fd);
+
+        /**
+         * @brief Arms the timerfd on an absolute deadline.
+         *
+         * @param deadline_ms Absolute CLOCK_REALTIME deadline in milliseconds, 0 disarms the timer.
+         */
+        void arm_timer(long deadline_ms);
+
+        /**
+         * @brief Waits for the next batch of events.
+         *
+         * @param block Sleep until an event arrives, otherwise only collect pending events.
+         * @return The number of events that were handled.
+         *
+         * Timer expirations and queued SIGCHLD signals are drained here and input events mark
+         * their input ready, other events only serve as wake-ups; the scheduler picks up the new
+         * state in the next monitor pass.
+         */
+        int wait(bool block);
+
+        /**
+         * @brief Returns the owners (task ids) of the input tables that became full in wait(), the caller clears the list.
+         */
+        std::vector<int>& get_filled_inputs() { return m_filledInputs; }
+
+        /**
+         * @brief Restores the default signal mask in a freshly forked child.
+         */
+        void reset_child_signals();
+
+        bool get_pidfd_supported() { return m_pidfd_supported; }
+};
+
+#endif
@@ -0,0 +1,142 @@
+/**
+ * @file graph.h
+ * @brief This file contains the loader of task graph files.
+ *
+ * A graph file describes the tasks, voters and pipes of a run, so a graph can be deployed without a
+ * rebuild (`--graph <file>`). The format is a subset of TOML: top level keys, `[[task]]` and `[[voter]]`
+ * tables and `key = value` lines, where a value is an integer, a number, a "string" or a list of strings.
+ *
+ *     name = "pipeline"
+ *
+ *     [[task]]
+ *     name = "A"
+ *     period = 100
+ *     outputs = ["a_b1", "a_b2", "a_b3"]
+ *
+ *     [[task]]
+ *     name = "B1"
+ *     inputs = ["a_b1"]
+ *     outputs = ["b1_v"]
+ *     ...
+ *
+ *     [[voter]]
+ *     name = "V"
+ *     type = "weighted"
+ *     replicas = ["B1", "B2", "B3"]
+ *     outputs = ["v_c"]
+ *
+ * A pipe is named by the tasks that use it: it has exactly one writer (an output) and, unless the writer
+ * is a replicate, one reader (an input). A voter reads the outputs of its replicates itself. The keys of
+ * a table are:
+ * - task: name, job ("workload"), period (0, data-driven), offset (0), priority (by depth), inputs,
+ *   outputs, input_size (8), cost_mean (busy_time), cost_jitter (0), fault_rate (0)
+ * - voter: name, job ("vote"), type ("standard" or "weighted"), replicas, outputs, priority, quorum
+ *   (VOTER_QUORUM, or 0 to wait for every replicate), cost_mean (1), cost_jitter (0), fault_rate (0)
+ *
+ * A job is a task function registered by name, "workload" and "vote" are the token passing functions of
+ * workload.h. The graph is checked once when it is loaded (unknown names, dangling pipes, cycles and
+ * replica sets) and compiled into flat arrays: the tasks in topological order, their inputs and outputs
+ * as index ranges into one edge array each, and the replica groups as ranges into one replica array.
+ * build() hands the output edges and the replica groups to the scheduler as the dependents and voters
+ * of its tasks, so waking the consumers of a task that completed walks one contiguous range.
+ */
+
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <string>
+#include <vector>
+
+#include "defines.h"
+#include "scheduler.h"
+#include "pipe.h"
+
+using namespace std;
+
+typedef void (*graph_job)(void);
+
+typedef struct graph_task {
+    string name;
+    graph_job job;
+    unsigned long period;
+    unsigned long offset;
+    int priority;
+    int depth;                                      // The longest path from a source, 0 for the sources
+    int input_size;
+    int cost_mean;
+    int cost_jitter;
+    double fault_rate;
+    bool voter;
+    voter_type type;
+    int quorum;                                     // 0 to wait for every replicate
+    int group;                                      // The replica group of a voter, or of a replicate; -1 if none
+    int first_input, inputs;                        // Range in the input edges
+    int first_output, outputs;                      // Range in the output edges
+} graph_task;
+
+typedef struct graph_edge {
+    int pipe;                                       // Index in the pipe names
+    int producer;                                   // Index of the writing task
+    int consumer;                                   // Index of the reading task, the voter for the output of a replicate
+} graph_edge;
+
+typedef struct graph_group {
+    int voter;                                      // Index of the voter
+    int first_replica, replicas;                    // Range in the replicas
+} graph_group;
+
+class graph {
+    private:
+        string m_name;
+        vector<graph_task> m_tasks;                 // In topological order, a producer comes before its consumers
+        vector<graph_edge> m_inputs;                // Grouped by consumer, in task order
+        vector<graph_edge> m_outputs;               // Grouped by producer, in task order
+        vector<graph_group> m_groups;
+        vector<int> m_replicas;                     // Task indices, grouped by replica group
+        vector<string> m_pipeNames;
+        vector<Pipe*> m_pipes;
+
+        graph() {}
+
+    public:
+        /**
+         * @brief Registers a task function, graph files refer to it by name.
+         *
+         * @param name The name of the job.
+         * @param job The task function.
+         */
+        static void register_job(const string &name, graph_job job);
+
+        /**
+         * @brief Reads, checks and compiles a graph file.
+         *
+         * @param path The path of the graph file.
+         * @return Pointer to the graph, or NULL if the file cannot be read or is invalid (the errors are printed).
+         */
+        static graph* load_graph(const string &path);
+
+        /**
+         * @brief Declares the pipes, tasks and voters of the graph and adds them to a scheduler.
+         *
+         * The tasks are added in topological order and their dependents are set from the output edges. If
+         * SIMULATION is defined the pipes only count tokens, no descriptors are created.
+         *
+         * @param s The scheduler, its cores are initialized and it has no tasks yet.
+         */
+        void build(scheduler *s);
+
+        /**
+         * @brief Closes the descriptors of the pipes, call after the scheduler was cleaned up.
+         */
+        void close_pipes();
+
+        const string& get_name() { return m_name; }
+        const vector<graph_task>& get_tasks() { return m_tasks; }
+        const vector<graph_edge>& get_inputs() { return m_inputs; }
+        const vector<graph_edge>& get_outputs() { return m_outputs; }
+        const vector<graph_group>& get_groups() { return m_groups; }
+        const vector<int>& get_replicas() { return m_replicas; }
+        size_t get_pipes() { return m_pipeNames.size(); }
+};
+
+#endif
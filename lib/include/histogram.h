@@ -0,0 +1,86 @@
+/**
+ * @file histogram.h
+ * @brief This file contains the log-bucketed latency histogram used for the per-task timing statistics.
+ *
+ * The histogram follows the HDR layout: values below 2^LATENCY_PRECISION_BITS get a bucket each, every
+ * next power of two is split in 2^(LATENCY_PRECISION_BITS - 1) equally wide buckets. The relative error
+ * of a reported value is therefore at most 2^-(LATENCY_PRECISION_BITS - 1), from a nanosecond up to
+ * 2^LATENCY_RANGE_BITS nanoseconds. The counts are a fixed array inside the object: recording a value is
+ * a count-leading-zeros, a shift and an increment, nothing is allocated.
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+
+#include "defines.h"
+
+#define LATENCY_HALF_BUCKETS (1 << (LATENCY_PRECISION_BITS - 1))
+#define LATENCY_BUCKETS ((LATENCY_RANGE_BITS - LATENCY_PRECISION_BITS + 2) * LATENCY_HALF_BUCKETS)
+
+class latency_histogram {
+    private:
+        uint64_t m_counts[LATENCY_BUCKETS] = { 0 };
+        uint64_t m_count { 0 };
+        uint64_t m_min { UINT64_MAX };
+        uint64_t m_max { 0 };
+        double m_sum { 0 };
+
+        static int bucket_of(uint64_t value)
+        {
+            if (value < 2 * LATENCY_HALF_BUCKETS)
+                return (int)value;
+
+            int msb = 63 - __builtin_clzll(value);
+
+            if (msb >= LATENCY_RANGE_BITS)
+                return LATENCY_BUCKETS - 1;
+
+            int shift = msb - LATENCY_PRECISION_BITS + 1;
+            return shift * LATENCY_HALF_BUCKETS + (int)(value >> shift);
+        }
+
+        static uint64_t highest_of(int bucket);
+
+    public:
+        /**
+         * @brief Counts one value.
+         *
+         * @param value The value in nanoseconds, values beyond the range are counted in the last bucket.
+         */
+        void record(uint64_t value)
+        {
+            m_counts[bucket_of(value)]++;
+            m_count++;
+            m_sum += value;
+
+            if (value < m_min)
+                m_min = value;
+
+            if (value > m_max)
+                m_max = value;
+        }
+
+        /**
+         * @brief Returns the value below or at which the given percentage of the values lies.
+         *
+         * @param percentile The percentile, between 0 and 100.
+         * @return The highest value of the bucket the percentile falls in (at most the max), 0 if empty.
+         */
+        uint64_t percentile(double percentile) const;
+
+        /**
+         * @brief Adds the values counted by another histogram.
+         *
+         * @param other The histogram to add.
+         */
+        void merge(const latency_histogram &other);
+
+        uint64_t get_count() const { return m_count; }
+        uint64_t get_min() const { return m_count ? m_min : 0; }
+        uint64_t get_max() const { return m_max; }
+        double get_mean() const { return m_count ? m_sum / m_count : 0; }
+};
+
+#endif
@@ -0,0 +1,122 @@
+/**
+ * @file input_table.h
+ * @brief This file contains the table of the inputs of a task and their readiness bitmap.
+ *
+ * The inputs are kept as a structure of arrays (descriptors, sizes, pipes and channels in their own
+ * contiguous vectors) instead of a linked list, so the hot loop walks plain arrays. Every input owns a
+ * bit in the readiness bitmap. A bit is set once its input was seen readable and stays set until the
+ * task consumed its inputs (clear_ready() when a run ends), because only the task itself reads from
+ * its inputs.
+ *
+ * The bits are set by the event loop: every input with a descriptor is registered once with its
+ * epoll instance (watch()), edge-triggered, and a readiness event sets the bit of its input. A count
+ * of the set bits makes full() one comparison, so checking a task takes no syscalls and there is no
+ * limit on the descriptor numbers. Only after a run ended, when the bits were cleared, the inputs
+ * that still hold data are probed once with poll() (refresh()), as their edges were already reported.
+ */
+
+#ifndef INPUT_TABLE_H
+#define INPUT_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <poll.h>
+#include <vector>
+#include <algorithm>
+
+#include "defines.h"
+#include "pipe.h"
+#include "channel.h"
+#include "event_loop.h"
+
+using namespace std;
+
+class input_table {
+    private:
+        vector<int> m_fds;                  // Read end of a pipe, or the notify fd of a channel
+        vector<int> m_sizes;
+        vector<Pipe*> m_pipes;              // NULL for channel inputs
+        vector<Channel*> m_channels;        // NULL for pipe inputs
+        vector<uint64_t> m_ready;           // Bit i is set once input i was seen readable
+        size_t m_readyCount { 0 };          // The number of set bits
+        vector<event_source> m_sources;     // The input_ready source of every input, registered by watch()
+        bool m_stale { true };              // The bits were cleared, pending data has not been probed yet
+        int m_owner { -1 };                 // The id of the task the inputs belong to
+        vector<struct pollfd> m_poll;       // The pipes of a probe, kept to reuse the allocation
+        vector<size_t> m_pollInputs;        // The input of every entry in m_poll
+
+    public:
+        /**
+         * @brief Adds an input, its readiness bit starts clear.
+         *
+         * @param fd The descriptor that becomes readable with the input, -1 if there is none.
+         * @param size The size of a message.
+         * @param p The pipe, NULL for a channel input.
+         * @param c The channel, NULL for a pipe input.
+         */
+        void add(int fd, int size, Pipe *p, Channel *c);
+
+        size_t size() const { return m_fds.size(); }
+        void set_owner(int id) { m_owner = id; }
+        int get_owner() const { return m_owner; }
+        int get_fd(size_t i) const { return m_fds[i]; }
+        int get_size(size_t i) const { return m_sizes[i]; }
+        Pipe* get_pipe(size_t i) const { return m_pipes[i]; }
+        Channel* get_channel(size_t i) const { return m_channels[i]; }
+
+        void set_ready(size_t i)
+        {
+            uint64_t bit = (uint64_t)1 << (i % 64);
+
+            if (!(m_ready[i / 64] & bit))
+            {
+                m_ready[i / 64] |= bit;
+                m_readyCount++;
+            }
+        }
+
+        bool get_ready(size_t i) const { return m_ready[i / 64] & ((uint64_t)1 << (i % 64)); }
+
+        /**
+         * @brief Forgets the readiness of all inputs, call when a run of the task ended.
+         *
+         * Drain the events of the inputs before, the next refresh() probes the data that is left.
+         */
+        void clear_ready()
+        {
+            fill(m_ready.begin(), m_ready.end(), 0);
+            m_readyCount = 0;
+            m_stale = true;
+        }
+
+        /**
+         * @brief Returns whether every input was seen readable, true for a task without inputs.
+         */
+        bool full() const { return m_readyCount == m_fds.size(); }
+
+        /**
+         * @brief Registers every input that has a descriptor with an event loop, edge-triggered.
+         *
+         * The table must not grow or move afterwards, the events point into it.
+         *
+         * @param events The event loop, its wait() sets the bits of the inputs that became readable.
+         */
+        void watch(event_loop *events);
+
+        /**
+         * @brief Brings the bits up to date without waiting on the event loop.
+         *
+         * Channels are checked in shared memory. If the bits were cleared since the last refresh, the pipes
+         * whose bit is still clear are probed with one poll().
+         */
+        void refresh();
+
+        /**
+         * @brief Sets the bits of the inputs that are readable now.
+         *
+         * Channels are checked in shared memory, the pipes whose bit is still clear with one poll().
+         */
+        void probe();
+};
+
+#endif
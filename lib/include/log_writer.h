@@ -0,0 +1,103 @@
+/**
+ * @file log_writer.h
+ * @brief This file contains the asynchronous logging pipeline of the scheduler (if ASYNC_LOGGING is defined).
+ *
+ * The scheduler copies each sample into a preallocated lock-free single-producer/single-consumer ring:
+ * a handful of stores and one release store of the head, no allocation, no syscall. A writer thread,
+ * pinned to every CPU but the one of the scheduler core, drains the ring and streams the rows to cores.tsv,
+ * weights.tsv and tasks.tsv (or to the compact trace.bin if LOG_BINARY is defined, see trace.h)
+ * while the scheduler runs. The memory use is constant, and a crash only loses the samples of the
+ * last writer period.
+ */
+
+#ifndef LOG_WRITER_H
+#define LOG_WRITER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "defines.h"
+#include "task.h"
+#include "core.h"
+#include "trace.h"
+
+using namespace std;
+
+typedef struct log_sample {
+    long time;
+    int *core_runs;                         // One value per core
+    float *weights;                         // One value per core
+    int *task_success;                      // One value per logged task
+} log_sample;
+
+class log_writer {
+    private:
+        log_sample *m_ring { NULL };
+        alignas(CACHE_LINE_SIZE) atomic<uint64_t> m_head { 0 };    // Samples pushed, only stored by the scheduler
+        alignas(CACHE_LINE_SIZE) atomic<uint64_t> m_tail { 0 };    // Samples written, only stored by the writer thread
+        alignas(CACHE_LINE_SIZE) atomic<bool> m_running { false };
+        uint64_t m_dropped { 0 };           // Samples lost because the ring was full
+
+        pthread_t m_thread;
+        size_t m_numCores { 0 };
+        size_t m_numTasks { 0 };
+        vector<int> m_coreRuns;             // [slot * m_numCores + core], the ring slots point into the columns
+        vector<float> m_weights;            // [slot * m_numCores + core]
+        vector<int> m_taskSuccess;          // [slot * m_numTasks + task]
+
+        FILE *m_coreFile { NULL };
+        FILE *m_weightFile { NULL };
+        FILE *m_taskFile { NULL };
+        trace_writer m_trace;
+
+        static void* writer_main(void *arg);
+        size_t drain();
+        void write_sample(const log_sample &sample);
+
+    public:
+        /**
+         * @brief Opens the output files, writes their banners, sizes the ring and starts the writer thread.
+         *
+         * @param directory The directory the files are created in.
+         * @param tasks The tasks to log, the ring holds LOG_RING_SLOTS samples of this many tasks.
+         * @param cores The cores of the scheduler.
+         * @return true if the writer runs; false if the files could not be opened.
+         */
+        bool start(const string &directory, const vector<task*> &tasks, const vector<core*> &cores);
+
+        /**
+         * @brief Copies a sample of all cores and tasks into the ring.
+         *
+         * Never blocks the scheduler: if the ring is full the sample is dropped and counted. Only if
+         * SIMULATION is defined it waits for the writer, the virtual clock does not move meanwhile.
+         *
+         * @param time The time of the sample in milliseconds since the scheduler started.
+         * @param tasks The tasks of the scheduler, the first ones in the order passed to start(), the others are not logged.
+         * @param cores The cores of the scheduler, in the order passed to start().
+         */
+        void push(long time, const vector<task*> &tasks, const vector<core*> &cores);
+
+        /**
+         * @brief Stops the writer thread, writes the remaining samples and closes the .tsv files.
+         *
+         * The trace (if LOG_BINARY is defined) stays open until close_trace().
+         */
+        void stop();
+
+        /**
+         * @brief Writes the summary block and closes the trace, call after stop().
+         *
+         * @param summary The text of summary.txt, may be NULL.
+         * @param size The size of the summary.
+         */
+        void close_trace(const char *summary, size_t size) { m_trace.close(summary, size); }
+
+        uint64_t get_written() { return m_tail.load(memory_order_acquire); }
+        uint64_t get_dropped() { return m_dropped; }
+};
+
+#endif
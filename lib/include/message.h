@@ -0,0 +1,127 @@
+/**
+ * @file message.h
+ * @brief This file contains the typed, fixed-layout message format used on pipes and channels.
+ *
+ * A message is a plain struct that starts with a message_header and has a static `message_id`
+ * and `message_version`. The header carries a magic number, the version and type of the message,
+ * the payload length and a checksum over the payload, so a consumer can validate a message it
+ * read without parsing anything. It also carries the origin of the data for the end-to-end latency
+ * tracking (see e2e.h): the time the source sampled it, a chain ID per sample and the path it took.
+ * The source of a chain stamps its message with message_originate(), every next hop copies the
+ * stamp of its input with message_forward().
+ *
+ * Example:
+ *     typedef struct sensor_message {
+ *         static constexpr uint8_t message_id = 1;
+ *         static constexpr uint8_t message_version = 1;
+ *         message_header header;
+ *         double roll;
+ *     } sensor_message;
+ */
+
+#ifndef MESSAGE_H
+#define MESSAGE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <type_traits>
+
+#define MESSAGE_MAGIC 0x4e52                // "RN"
+
+typedef struct message_header {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t type;
+    uint32_t length;                        // Size of the payload (everything after the header)
+    uint32_t checksum;                      // FNV-1a over the payload
+    uint32_t chain;                         // Sequence number of the source sample
+    uint64_t origin;                        // Time (in nanoseconds, see message_clock()) the source sampled the data, 0 if untracked
+    uint32_t path;                          // The end-to-end path the message is on
+    uint32_t reserved;
+} message_header;
+
+/**
+ * @brief Computes the FNV-1a checksum of a buffer.
+ *
+ * @param data The buffer.
+ * @param size The size of the buffer in bytes.
+ * @return The 32-bit checksum.
+ */
+uint32_t message_checksum(const void *data, size_t size);
+
+/**
+ * @brief Returns the monotonic time in nanoseconds, the same clock in every process.
+ */
+uint64_t message_clock();
+
+/**
+ * @brief Stamps a message as the start of a new chain.
+ *
+ * @param msg The message.
+ * @param chain The chain ID, see e2e_tracker::next_chain().
+ */
+template <typename T>
+void message_originate(T &msg, uint32_t chain)
+{
+    msg.header.origin = message_clock();
+    msg.header.chain = chain;
+    msg.header.path = 0;
+}
+
+/**
+ * @brief Copies the chain of the input a message was computed from.
+ *
+ * @param out The message that is sent.
+ * @param in The message it was computed from.
+ * @param path The path to put the message on, 0 keeps the path of the input.
+ */
+template <typename T, typename U>
+void message_forward(T &out, const U &in, uint32_t path)
+{
+    out.header.origin = in.header.origin;
+    out.header.chain = in.header.chain;
+    out.header.path = path ? path : in.header.path;
+}
+
+/**
+ * @brief Fills in the header of a message, call before sending it.
+ *
+ * The chain stamp of the message is left as it is.
+ *
+ * @param msg The message to seal.
+ */
+template <typename T>
+void message_seal(T &msg)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "messages have to be plain structs");
+    static_assert(offsetof(T, header) == 0, "messages have to start with a message_header");
+
+    const char *payload = reinterpret_cast<const char*>(&msg) + sizeof(message_header);
+
+    msg.header.magic = MESSAGE_MAGIC;
+    msg.header.version = T::message_version;
+    msg.header.type = T::message_id;
+    msg.header.length = sizeof(T) - sizeof(message_header);
+    msg.header.reserved = 0;
+    msg.header.checksum = message_checksum(payload, msg.header.length);
+}
+
+/**
+ * @brief Checks the header and checksum of a received message.
+ *
+ * @param msg The message to validate.
+ * @return true if the message has the expected type, version and layout and the checksum matches.
+ */
+template <typename T>
+bool message_valid(const T &msg)
+{
+    const char *payload = reinterpret_cast<const char*>(&msg) + sizeof(message_header);
+
+    return msg.header.magic == MESSAGE_MAGIC &&
+           msg.header.version == T::message_version &&
+           msg.header.type == T::message_id &&
+           msg.header.length == sizeof(T) - sizeof(message_header) &&
+           msg.header.checksum == message_checksum(payload, msg.header.length);
+}
+
+#endif
@@ -0,0 +1,76 @@
+/**
+ * @file metrics.h
+ * @brief This file contains the preallocated, columnar store of the samples logged by the scheduler.
+ *
+ * Every MAX_LOG_INTERVAL the scheduler samples the runs and weight of each core and the successful
+ * runs of each task. The store keeps one contiguous array per metric, indexed by sample (and core or
+ * task). The arrays grow by doubling until they hold the capacity, which is bounded by MAX_LOG_BYTES,
+ * so a short run or a large task set does not allocate MAX_LOG_SAMPLES rows up front. Once the store
+ * is full the oldest samples are overwritten, so the memory footprint is bounded regardless of how
+ * long the scheduler runs.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stddef.h>
+#include <vector>
+
+#include "defines.h"
+#include "task.h"
+#include "core.h"
+
+using namespace std;
+
+class metrics_store {
+    private:
+        size_t m_capacity { 0 };
+        size_t m_rows { 0 };                // Number of samples allocated, grows up to m_capacity
+        size_t m_numCores { 0 };
+        size_t m_numTasks { 0 };
+        size_t m_next { 0 };                // Slot of the next sample
+        size_t m_count { 0 };               // Number of samples stored, at most m_capacity
+        size_t m_dropped { 0 };             // Number of samples that were overwritten
+
+        vector<long> m_time;                // [sample]
+        vector<int> m_coreRuns;             // [sample * m_numCores + core]
+        vector<float> m_weights;            // [sample * m_numCores + core]
+        vector<int> m_taskSuccess;          // [sample * m_numTasks + task]
+
+        size_t slot(size_t sample) const { return (m_next + m_capacity - m_count + sample) % m_capacity; }
+
+        void grow();
+
+    public:
+        /**
+         * @brief Sets the shape of the samples, call once before the first sample.
+         *
+         * @param cores The number of cores per sample.
+         * @param tasks The number of tasks per sample, the first tasks passed to record().
+         * @param capacity The max number of samples, lowered to fit MAX_LOG_BYTES. Older samples are overwritten.
+         */
+        void init(size_t cores, size_t tasks, size_t capacity);
+
+        /**
+         * @brief Stores one sample of all cores and tasks.
+         *
+         * @param time The time of the sample in milliseconds since the scheduler started.
+         * @param tasks The tasks of the scheduler, in the order passed to init().
+         * @param cores The cores of the scheduler, in the order passed to init().
+         */
+        void record(long time, const vector<task*> &tasks, const vector<core*> &cores);
+
+        size_t size() const { return m_count; }
+        size_t get_capacity() const { return m_capacity; }
+        size_t get_dropped() const { return m_dropped; }
+
+        /**
+         * @brief Accessors of a stored sample, 0 is the oldest sample.
+         */
+        long time(size_t sample) const { return m_time[slot(sample)]; }
+        int core_runs(size_t sample, size_t c) const { return m_coreRuns[slot(sample) * m_numCores + c]; }
+        float weight(size_t sample, size_t c) const { return m_weights[slot(sample) * m_numCores + c]; }
+        int task_success(size_t sample, size_t t) const { return m_taskSuccess[slot(sample) * m_numTasks + t]; }
+};
+
+#endif
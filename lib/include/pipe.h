@@ -26,18 +26,21 @@
 #include <stdbool.h>
 
 #include "defines.h"
+#include "message.h"
 //#include "task.h"
 
 class Pipe {
     private:
         int m_read_fd;               // File descriptor for the read end
         int m_write_fd;              // File descriptor for the write end
-        char *m_name;                // Name of the pipe
+        char *m_name { NULL };       // Name of the pipe
+        int m_tokens { 0 };          // Messages in flight if SIMULATION is defined
         //struct Pipe *m_next;         // Pointer to the next pipe in the list
 
     public:
         Pipe();
         Pipe(int read_fd, int write_fd, const char* name);
+        ~Pipe() { free(m_name); }
 
         /**
          * @brief Creates a new pipe and returns a Pipe object.
@@ -51,11 +54,75 @@ class Pipe {
 
         int get_write_fd() { return m_write_fd; }
 
+        /**
+         * @brief Counts simulated messages, a simulated task consumes and produces tokens instead of data.
+         */
+        int get_tokens() { return m_tokens; }
+        void add_token() { m_tokens++; }
+        void take_token() { if (m_tokens) m_tokens--; }
+
         //char* get_name() { return m_name; }
 
         bool read_data(char *buffer, size_t buf_size);
 
         void write_data(const char *buffer);
+
+        /**
+         * @brief Reads exactly one message of the given size from the pipe.
+         * 
+         * @param buffer Buffer to store the message.
+         * @param size Size of the message.
+         * @return true if a complete message was read; false otherwise.
+         */
+        bool read_raw(void *buffer, size_t size);
+
+        /**
+         * @brief Reads every complete message that is available and keeps the newest one.
+         * 
+         * Used by voters, a replicate that finished after an early vote leaves a stale message behind.
+         * 
+         * @param buffer Buffer to store the message.
+         * @param size Size of the message.
+         * @return true if at least one complete message was read; false otherwise.
+         */
+        bool read_latest_raw(void *buffer, size_t size);
+
+        /**
+         * @brief Writes one message of the given size to the pipe.
+         * 
+         * @param buffer Buffer containing the message.
+         * @param size Size of the message, at most PIPE_BUF so the write is atomic.
+         * @return true if the complete message was written; false otherwise.
+         */
+        bool write_raw(const void *buffer, size_t size);
+
+        /**
+         * @brief Seals and writes a typed message (see message.h).
+         */
+        template <typename T>
+        bool write_message(T &msg) 
+        { 
+            message_seal(msg); 
+            return write_raw(&msg, sizeof(T)); 
+        }
+
+        /**
+         * @brief Reads a typed message and validates its header and checksum.
+         */
+        template <typename T>
+        bool read_message(T &msg) 
+        { 
+            return read_raw(&msg, sizeof(T)) && message_valid(msg); 
+        }
+
+        /**
+         * @brief Reads the newest available typed message and validates it.
+         */
+        template <typename T>
+        bool read_latest_message(T &msg) 
+        { 
+            return read_latest_raw(&msg, sizeof(T)) && message_valid(msg); 
+        }
 };
 
 /**
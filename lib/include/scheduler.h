@@ -13,14 +13,25 @@
 
 #include <stdbool.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <vector>
+#include <queue>
 #include <string>
+#include <random>
+#include <algorithm>
 
 #include "defines.h"
 #include "task.h"
 #include "core.h"
-#include "result.h"
+#include "metrics.h"
+#include "log_writer.h"
 #include "voter.h"
+#include "event_loop.h"
+#include "worker.h"
+#include "deadline_heap.h"
+#include "core_index.h"
+#include "e2e.h"
+#include "timeline.h"
 
 using namespace std;
 
@@ -33,14 +44,42 @@ struct CompareTask {
 class scheduler {
     private:
         vector<task*> m_tasks;
+        vector<task*> m_monitorOrder;                                       // m_tasks sorted on priority, highest first
+        vector<int> m_rank;                                                 // Position of every task (by id) in m_monitorOrder
+        vector<task*> m_running;                                            // The tasks with a running job, polled every pass
+        vector<int> m_runningSlot;                                          // Position of every task in m_running, -1 if not running
+        vector<task*> m_woken;                                              // The tasks to check in the next pass, see wake_task()
+        vector<bool> m_isWoken;                                             // Set for the tasks in m_woken
+        vector<task*> m_starved;                                            // Fireable tasks that found no free core
+        vector<task*> m_polled;                                             // Tasks with a channel input no event or producer wakes them for
+        vector<task*> m_passTasks;                                          // The tasks of the current pass, in monitor order
+        vector<int> m_firstDependent;                                       // The consumers of task i are m_dependents[m_firstDependent[i]] up to m_firstDependent[i + 1]
+        vector<task*> m_dependents;                                         // The consumers of the outputs of every task, grouped by producer in task order
+        vector<task*> m_voterOf;                                            // The voter of every replicate, NULL if none
+        priority_queue<task*, vector<task*>, CompareTask> m_readyQueue;     // Fireable tasks that have a core assigned
         vector<core*> m_cores;
-        vector<result> m_results;
+        core_index m_coreIndex;
+        metrics_store m_metrics;
+        log_writer m_logWriter;                                             // Streams the samples if ASYNC_LOGGING is defined
+        e2e_tracker *m_e2e { NULL };                                        // The end-to-end latencies recorded by the tasks, may be NULL
+        timeline m_timeline;                                                // The scheduler events if EVENT_TRACE is defined
         time_t m_activationTime;
         time_t m_log_timeout;
+        event_loop *m_events { NULL };
+        event_loop *m_readiness { NULL };                                   // Tracks the task inputs, m_events if EVENT_DRIVEN is defined
+        vector<worker*> m_workers;
+        deadline_heap m_deadlines;
+        bool m_progress { true };
+        long m_virtualTime { 0 };                                           // The clock in milliseconds if SIMULATION is defined
+        mt19937 m_rng { SIM_SEED };
+        latency_histogram m_tickCost;                                       // The real time of monitor_tasks() and run_tasks() per pass
+        bool m_logging { true };                                            // Sample the cores and tasks if LOGGING is defined
+        size_t m_loggedTasks { SIZE_MAX };                                  // Max number of tasks per sample, the first tasks are sampled
 
         int specialCounter{0};
 
         string m_outputDirectory {"results"};
+        string m_resultDirectory;                                           // Created on first use, empty before
         int m_runs { 0 };
 
     public:
@@ -51,14 +90,24 @@ class scheduler {
          * @brief Initializes the scheduler by setting up cores and CPU affinity.
          *
          * This function performs the following steps:
-         * - Initializes the cores by creating `NUM_OF_CORES` core objects with initial parameters and adds them to the `m_cores` list.
+         * - Initializes the cores by creating `CONFIG.cores` core objects with initial parameters and adds them to the `m_cores` list.
          * - Sets the activation time and log timeout to the current time.
-         * - Sets the CPU affinity to ensure the scheduler runs on a specific core (`SCHEDULER_CORE`).
+         * - Sets the CPU affinity to ensure the scheduler runs on a specific core (`CONFIG.scheduler_core`, offset by `CONFIG.cpu_base`).
          *
          * If setting the CPU affinity fails, the function prints an error message and exits the program.
          */
         void init_scheduler();
 
+        /**
+         * @brief Creates the cores and adds all but the scheduler core to the core index.
+         *
+         * Called by init_scheduler() with `CONFIG.cores`. Nothing is pinned, so the micro-benchmarks
+         * use it directly to build a scheduler with any number of cores.
+         *
+         * @param cores The number of cores.
+         */
+        void init_cores(int cores);
+
         /**
          * @brief Performs the scheduler loop.
          *
@@ -69,6 +118,130 @@ class scheduler {
          */
         void start_scheduler();
 
+        /**
+         * @brief Prepares a run: arms the deadlines and starts the logging, the event loop watches and the workers.
+         *
+         * Called by start_scheduler(). Has to be called after all tasks are added.
+         */
+        void prepare_run();
+
+        /**
+         * @brief Performs one pass of the scheduler loop.
+         *
+         * Monitors the tasks, dispatches the fireable ones, logs (if defined) and waits for the next
+         * event (if EVENT_DRIVEN is defined) or advances the virtual clock (if SIMULATION is defined).
+         * The real time spent in monitoring and dispatching is added to the tick cost histogram.
+         */
+        void run_pass();
+
+        /**
+         * @brief Sleeps until the next scheduler event (if EVENT_DRIVEN is defined).
+         *
+         * If the previous pass changed the state of a task (dispatch or completion), the function
+         * returns immediately so follow-up transitions (e.g. arming a voter) are handled right away.
+         * Otherwise the deadline timer is armed on the earliest upcoming deadline and the scheduler
+         * blocks until a child exits, an input pipe becomes readable or the deadline expires.
+         */
+        void wait_for_events();
+
+        /**
+         * @brief Advances the virtual clock to the next deadline (if SIMULATION is defined).
+         *
+         * Like wait_for_events(), a pass that changed the state of a task is followed by another pass at
+         * the same time. Otherwise the clock jumps straight to the earliest deadline: a release, a log
+         * interval or the completion of a simulated run.
+         */
+        void advance_clock();
+
+        /**
+         * @brief Starts a simulated run of a task (if SIMULATION is defined).
+         *
+         * @param t Pointer to the task, its core is already assigned.
+         *
+         * Consumes the input tokens of the task, samples the execution time and outcome from its cost model
+         * and pushes the completion of the run on the deadline heap.
+         */
+        void simulate_job(task *t);
+
+        /**
+         * @brief Registers every task input once with the readiness set (the event loop if EVENT_DRIVEN is defined).
+         *
+         * Not used if SIMULATION is defined, the inputs hold tokens instead of data.
+         */
+        void watch_inputs();
+
+        /**
+         * @brief Collects the pending input events without waiting, so the readiness bits of the tasks are current.
+         */
+        void collect_input_events();
+
+        /**
+         * @brief Pushes the initial offset and release deadline of every task on the deadline heap.
+         */
+        void init_deadlines();
+
+        /**
+         * @brief Builds the running and woken task sets and the dependents of every task, all tasks start woken.
+         *
+         * Called by prepare_run() after all tasks are added. A pass only checks the running tasks and the
+         * tasks that were woken since the previous pass, so its cost does not grow with waiting tasks. The
+         * dependents are derived from the task outputs, unless a graph set them (see set_dependents()).
+         */
+        void init_task_sets();
+
+        /**
+         * @brief Derives the dependents of every task from the outputs the tasks declared.
+         *
+         * A consumer of a channel that no task declares as an output is added to the polled tasks.
+         */
+        void derive_dependents();
+
+        /**
+         * @brief Makes monitor_tasks() check a task in the next pass.
+         *
+         * A task is woken when its release or offset expires, when its input table becomes full, when it
+         * or one of its producers completes, when a replicate of a voter is dispatched or completes, and
+         * when a core is released while it waits for one.
+         *
+         * @param t Pointer to the task.
+         */
+        void wake_task(task *t);
+
+        /**
+         * @brief Wakes the tasks whose input tables were reported full by the readiness set.
+         */
+        void wake_filled_inputs();
+
+        /**
+         * @brief Adds a dispatched task to the running set and wakes its voter, if it is a replicate.
+         */
+        void add_running(task *t);
+
+        /**
+         * @brief Removes a task whose run ended from the running set and wakes it, its consumers, its voter
+         * and the tasks that wait for a core.
+         */
+        void remove_running(task *t);
+
+        /**
+         * @brief Pops all expired deadlines and flags the tasks they belong to.
+         *
+         * @param currentTime The current time in milliseconds.
+         *
+         * An expired release marks the task as released, an expired offset marks its offset as elapsed (both
+         * wake the task) and an expired stuck timeout of the current run makes monitor_tasks() check whether the task is stuck.
+         * Only the tasks with an expired deadline are touched.
+         */
+        void expire_deadlines(unsigned long int currentTime);
+
+        /**
+         * @brief Finds the earliest deadline of all tasks and the logger.
+         *
+         * @param currentTime The current time in milliseconds.
+         * @return The earliest deadline in the future, 0 if there is none.
+         */
+        long next_deadline(long currentTime);
+
         /**
          * @brief Monitors and manages the state of all tasks in the scheduler.
          * 
@@ -77,17 +250,20 @@ class scheduler {
          * 
          * The function does the following:
          * - Retrieves the current time.
-         * - Iterates through all tasks to monitor their state.
+         * - Pops the expired deadlines, see expire_deadlines().
+         * - Iterates through the running tasks and the woken tasks (see wake_task()) in priority order (kept sorted
+         *   by add_task) to monitor their state. A task that waits for its inputs, its release or a core is not visited.
          * - For each task, it checks if the task's startup offset has elapsed. If not, it skips the task.
          * - For tasks that are currently running, it checks the state of the child process using `waitpid`.
-         *   - If the task is still running (`result == 0`), it checks if the task is stuck. If it is, it marks the 
-         *     task as crashed, increments the failure count, and decreases the core's weight.
+         *   - If the task is still running (`result == 0`) and its stuck timeout expired, it checks if the task is 
+         *     stuck. If it is, it marks the task as crashed, increments the failure count, and decreases the core's weight.
          *   - If the task has finished or an error occurred, it sets the latest status and result for the task, and 
          *     calls `handle_task_completion` to process the task's completion.
-         * - If the task is not running and its input is full, and the period has elapsed, it prepares the task for 
+         * - If the task is not running and its input is full, and it has been released, it prepares the task for 
          *   launching:
          *   - It sets the task to fireable and attempts to find a core to run the task on.
-         *   - If a core is found, it assigns the core ID to the task. Otherwise, it marks the task as not fireable.
+         *   - If a core is found, it assigns the core ID to the task and pushes it on the ready queue. 
+         *     Otherwise, it marks the task as not fireable and wakes it again when a core is released.
          */
         void monitor_tasks();
 
@@ -111,10 +287,41 @@ class scheduler {
          */
         void handle_task_completion(task *t, int status, pid_t result);
 
+        /**
+         * @brief Kills the job of a running task and releases its core.
+         *
+         * @param t Pointer to the running task.
+         *
+         * Used for the laggards of an early vote (if CANCEL_LAGGARDS is defined). The job is killed and reaped,
+         * or its worker is replaced if WORKER_POOL is defined. The run is counted as cancelled instead of failed,
+         * and the reliability weight of the core is left untouched. A job that already finished is handled as a
+         * normal completion.
+         */
+        void cancel_task(task *t);
+
+        /**
+         * @brief Checks whether the job of a running task has finished.
+         *
+         * @param t Pointer to the running task.
+         * @param status Set to the waitpid encoded status of the job.
+         * @return 0 if the job is still running, -1 on error, otherwise the process that ran the job.
+         *
+         * Uses wait4() on the forked child, or the status channel of the worker if WORKER_POOL is defined.
+         * The resource usage of a completed job is stored in the task, see task::set_job_usage().
+         */
+        pid_t poll_job(task *t, int *status);
+
+        /**
+         * @brief Starts one persistent, pinned worker process per managed core (if WORKER_POOL is defined).
+         *
+         * Has to be called after all tasks and pipes are declared, the workers inherit them on fork.
+         */
+        void spawn_workers();
+
         /**
          * @brief Runs fireable tasks by forking processes and setting their CPU affinity.
          *
-         * This function iterates through all tasks and performs the following steps for each fireable task:
+         * This function drains the ready queue and performs the following steps for each fireable task:
          * - Sets the start time and increments the run count.
          * - Forks a new process for the task.
          * - In the child process, sets the CPU affinity for the task and runs the task.
@@ -127,12 +334,25 @@ class scheduler {
         /**
          * @brief Adds a task to the scheduler's task list.
          *
+         * The task is also inserted in the priority ordered monitor list, behind tasks with the same priority.
+         *
          * @param t Pointer to the task to be added.
          */
         void add_task(task *t);
 
         //void add_task(const string& name, int period, int offset, int priority, void (*function)(void));
 
+        /**
+         * @brief Sets the dependents of every task, instead of deriving them from the task outputs.
+         *
+         * Used by the graph loader, whose edges are already grouped by producer. Call after all tasks were added.
+         *
+         * @param firstDependent The consumers of task i are dependents[firstDependent[i]] up to firstDependent[i + 1].
+         * @param dependents The consumers of the outputs of every task, grouped by producer in task order.
+         * @param voterOf The voter of every task, NULL if it is not a replicate.
+         */
+        void set_dependents(const vector<int>& firstDependent, const vector<task*>& dependents, const vector<task*>& voterOf);
+
         /**
          * @brief Adds a voter task to the scheduler's task list.
          *
@@ -151,6 +371,8 @@ class scheduler {
 
 
         task* get_task(int i) { return m_tasks[i]; }
+        const vector<task*>& get_tasks() { return m_tasks; }
+        core* get_core(int i) { return m_cores[i]; }
 
         /**
         * @brief Finds a task by its name.
@@ -168,13 +390,22 @@ class scheduler {
          *
          * @return The ID of the free core if found, otherwise -1.
          *
-         * This function iterates through the cores (excluding the scheduler core) to find a free core for the task.
+         * This function reads the top of the core index (which excludes the scheduler core) to find a free core for the task.
          * - If `isVoter` is true, it finds the most reliable inactive core based on weight and run count.
          * - If `isVoter` is false, it finds any inactive core with the fewest runs.
+         * Ties are resolved to the lowest core ID.
          *
          * If no free core is found, it returns -1. Otherwise, it marks the found core as active and returns its ID.
          */
         int find_core(bool isVoter);
+
+        /**
+         * @brief Checks whether cancelling the laggards of the latest vote frees a core the voter may run on.
+         *
+         * @param v The voter.
+         * @param isWeighted Whether the voter needs a core of at least MIN_VOTER_CORE_WEIGHT.
+         */
+        bool laggards_free_core(voter *v, bool isWeighted);
         
         /**
          * @brief Checks if the scheduler is active based on the run time or task iterations.
@@ -182,19 +413,129 @@ class scheduler {
          * @return True if the scheduler is active, otherwise false.
          *
          * The function determines if the scheduler should continue running based on the following conditions:
-         * - If `TIME_BASED` is defined, it checks if the current time minus the activation time is less than `MAX_RUN_TIME`.
-         * - Otherwise, it checks if the total number of successes and failures for the first task is less than `MAX_ITERATIONS`.
+         * - If `TIME_BASED` is defined, it checks if the current time minus the activation time is less than `CONFIG.run_time`.
+         * - Otherwise, it checks if the total number of successes and failures for the first task is less than `CONFIG.iterations`.
          */
         bool active();
 
         void printResults();        
         void log_results();
         void write_results_to_tsv();
+
+        /**
+         * @brief Creates the result directory of this run, once.
+         *
+         * @return true if the directory exists; false if it could not be created.
+         */
+        bool create_result_directory();
+
+        /**
+         * @brief Writes the samples of the metrics store to cores.tsv, weights.tsv and tasks.tsv.
+         *
+         * @param directoryName The result directory.
+         */
+        void write_metrics_to_tsv(const string &directoryName);
+
+        /**
+         * @brief Writes the count, min, mean, percentiles and max of every latency histogram to latency.tsv.
+         *
+         * @param directoryName The result directory.
+         */
+        void write_latency_to_tsv(const string &directoryName);
+
+        /**
+         * @brief Writes the count, min, mean, percentiles and max of every end-to-end path to e2e.tsv.
+         *
+         * @param directoryName The result directory.
+         */
+        void write_e2e_to_tsv(const string &directoryName);
+
+        /**
+         * @brief Writes the summed performance counters of every task and core to counters.tsv (if PERF_COUNTERS is defined).
+         *
+         * @param directoryName The result directory.
+         */
+        void write_counters_to_tsv(const string &directoryName);
+
+        /**
+         * @brief Writes the summed CPU time, page faults and context switches of every task and core to rusage.tsv.
+         *
+         * @param directoryName The result directory.
+         */
+        void write_usage_to_tsv(const string &directoryName);
+
+        /**
+         * @brief Sets the end-to-end latency tracker that is reported with the results.
+         *
+         * @param tracker The tracker, shared with the tasks.
+         */
+        void set_e2e_tracker(e2e_tracker *tracker) { m_e2e = tracker; }
         string generateOutputString(const string& prefix);
         void setOutputDirectory(string name) {m_outputDirectory = name;} ;
         void create_parameter_file(string &path);
         long current_time_in_ms();
 
+        /**
+         * @brief Returns a monotonic timestamp in nanoseconds for the latency histograms.
+         *
+         * If SIMULATION is defined, this is the virtual clock in nanoseconds.
+         */
+        uint64_t current_time_in_ns();
+
+        /**
+         * @brief Returns the real monotonic time in nanoseconds, also if SIMULATION is defined.
+         */
+        static uint64_t monotonic_ns();
+
+        /**
+         * @brief Returns the real time each pass spent in monitor_tasks() and run_tasks(), see run_pass().
+         */
+        const latency_histogram& get_tick_cost() { return m_tickCost; }
+
+        /**
+         * @brief Enables or disables the sampling of the cores and tasks (only used if LOGGING is defined).
+         *
+         * Has to be set before prepare_run(). Large generated workloads disable it, the samples hold a value per task.
+         */
+        void set_logging(bool logging) { m_logging = logging; }
+
+        /**
+         * @brief Limits the sampling to the first tasks (only used if LOGGING is defined), the cores are always sampled.
+         *
+         * Has to be set before prepare_run(). Graph files with more than MAX_LOGGED_TASKS tasks set it.
+         */
+        void set_logged_tasks(size_t tasks) { m_loggedTasks = tasks; }
+
+        /**
+         * @brief Returns the number of tasks per sample.
+         */
+        size_t get_logged_tasks() { return min(m_loggedTasks, m_tasks.size()); }
+
+        /**
+         * @brief Records a scheduler event on the timeline (if EVENT_TRACE is defined, a no-op otherwise).
+         *
+         * @param time The time of the event in nanoseconds, pass the timestamp the caller already took.
+         * @param type The event.
+         * @param t The task the event belongs to, NULL if none.
+         * @param value The status or count that belongs to the event.
+         */
+        void trace_event(uint64_t time, timeline_event type, task *t, int value)
+        {
+#ifdef EVENT_TRACE
+            m_timeline.record(time, type, t ? t->get_id() : -1, t ? t->get_cpu_id() : -1, value);
+#endif
+        }
+
+        /**
+         * @brief Records a scheduler event at the current time, the clock is only read if EVENT_TRACE is defined.
+         */
+        void trace_event(timeline_event type, task *t, int value)
+        {
+#ifdef EVENT_TRACE
+            trace_event(current_time_in_ns(), type, t, value);
+#endif
+        }
+
 };
 
 
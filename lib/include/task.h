@@ -6,8 +6,16 @@
 #include <stdarg.h>
 #include <string>
 #include <vector>
+#include <atomic>
 #include <defines.h>
 #include <pipe.h>
+#include <channel.h>
+#include <input_table.h>
+#include <event_loop.h>
+#include <histogram.h>
+#include <counters.h>
+#include <usage.h>
+#include <config.h>
 
 #include <chrono>
 
@@ -20,31 +28,96 @@ enum task_state {
     crashed,
 };
 
-typedef struct input {
-    int fd;
-    int size;
-    struct input *next;
-} input;
+typedef struct output {
+    Pipe *pipe;             // NULL for channel outputs
+    Channel *channel;       // NULL for pipe outputs
+    struct output *next;
+} output;
+
+/**
+ * @brief The cost model of a task if SIMULATION is defined.
+ */
+typedef struct task_cost {
+    int mean;               // Mean execution time in milliseconds
+    int jitter;             // The execution time is uniform in [mean - jitter, mean + jitter]
+    double fault_rate;      // Probability that a run fails (exit status 1)
+} task_cost;
+
+/**
+ * @brief Thrown by task_exit() to end a task function with an exit status.
+ */
+typedef struct task_exit_status {
+    int status;
+} task_exit_status;
+
+/**
+ * @brief Ends the running task function with the given exit status.
+ * 
+ * Task functions should use this instead of exit(), so the same function can run in a
+ * forked child as well as in a persistent worker process.
+ * 
+ * @param status The exit status of the task, 0 on success.
+ */
+[[noreturn]] void task_exit(int status);
+
+/**
+ * @brief The output a replicate reported to its voter, in memory shared with the scheduler.
+ */
+typedef struct ballot {
+    std::atomic<int> run;                   // The run that cast the ballot, stored last
+    uint32_t chain;                         // Chain ID of the output
+    uint64_t digest;                        // Digest of the output, outputs that agree have the same digest
+} ballot;
+
+/**
+ * @brief Reports the output of the running replicate to its voter.
+ *
+ * A voter with a quorum only fires before all its replicates finished when the quorum of them reported
+ * the same chain and digest in their current run. Does nothing in a task that is not a replicate.
+ *
+ * @param chain The chain ID of the output, see message_forward().
+ * @param digest The digest of the output.
+ */
+void task_vote(uint32_t chain, uint64_t digest);
+
+/**
+ * @brief The timing statistics kept per task, see task::get_latency().
+ */
+enum latency_metric {
+    latency_dispatch,       // From fireable (released and inputs full) to running
+    latency_execution,      // From running to completion
+    latency_response,       // From release to completion
+    latency_jitter,         // Deviation of the time between two dispatches from the period, periodic tasks only
+    NUM_LATENCY_METRICS,
+};
+
+extern const char *latency_metric_names[NUM_LATENCY_METRICS];
 
 typedef struct replicate {
     string name;
     bool armed;
+    int laggardRun;                         // Run that was still going when its round was voted on, -1 if none
 } replicate;
 
 class task {
     private:
+        static task *s_current;             // Set by run() in the process that runs the task
         string m_name;
+        int m_id { -1 };
         int m_cpu_id;
         bool m_active { false };
         bool m_fireable;
         int m_priority;
         
-        pid_t m_pid;
+        pid_t m_pid { 0 };
         void (*m_function)(void);
-        input *m_inputs { NULL };
+        input_table m_inputs;
+        output *m_outputs { NULL };
+        ballot *m_ballot { NULL };          // Shared with the voter if the task is a replicate
         int m_success { 0 };
         int m_fails { 0 };
         int m_errors { 0 };
+        int m_cancelled { 0 };
         int m_inputErrors { 0 };
         bool m_voter { false };
         int m_runs { 0 };
@@ -59,9 +132,29 @@ class task {
         unsigned long int m_startTime { 0 };
         long long m_runTime { 0 };
         task_state m_state;
-        int m_coreRuns[NUM_OF_CORES];
+        int m_coreRuns[MAX_CORES];
         pid_t m_latestResult;
         int m_latestStatus;
+        int m_pidfd { -1 };
+        bool m_released { true };           // Set by the deadline heap when the period elapsed
+        bool m_offsetElapsed { true };      // Set by the deadline heap when the offset elapsed
+        bool m_stuckCheck { false };        // Set by the deadline heap when the stuck timeout expired
+        event_source m_exitEvent { child_exit, this };
+        task_cost m_cost { CONFIG.busy_time, 0, 0.0 };
+        bool m_simDone { false };           // Set by the deadline heap when the simulated run completes
+        int m_simStatus { 0 };              // The sampled waitpid status of the simulated run
+
+        latency_histogram m_latency[NUM_LATENCY_METRICS];
+        uint64_t m_releaseNs { 0 };         // Time the current period was released, 0 if it was released at dispatch
+        uint64_t m_readyNs { 0 };           // Time the task first became fireable, 0 if it is not fireable
+        uint64_t m_dispatchNs { 0 };        // Time the current run was dispatched
+        uint64_t m_runReleaseNs { 0 };      // Release of the current run
+
+        perf_counters m_perf;               // Counters of the running job (if PERF_COUNTERS is defined)
+        counter_totals m_counters {};       // Summed counters of the jobs of this task
+        job_usage m_jobUsage {};            // Resource usage of the job that was reaped last
+        bool m_jobUsageValid { false };     // Set when the job was reaped with its usage
+        usage_totals m_usage {};            // Summed resource usage of the jobs of this task
 
         std::chrono::time_point<std::chrono::high_resolution_clock> m_timer;
 
@@ -82,6 +175,8 @@ class task {
             m_runTime += std::chrono::duration_cast<std::chrono::milliseconds>(now - getStartTime()).count();
         }
 
+        void addRuntime(long long runtime) { m_runTime += runtime; }
+
         long long getRuntime() { return m_runTime; }
 
         // Getter for startTime
@@ -105,24 +200,6 @@ class task {
          */
         task(const string& name, unsigned long int period, unsigned long int offset, int priority, void (*function)(void));
 
-        /**
-         * @brief Checks if the offset time has elapsed since the task started.
-         * 
-         * @param startTime The start time of the task.
-         * @param currentTime The current time.
-         * @return true if the offset has elapsed, false otherwise.
-         */
-        bool offset_elapsed(unsigned long int startTime, unsigned long int currentTime);
-
-
-        /**
-         * @brief Checks if the period time has elapsed since the task started.
-         * 
-         * @param currentTime The current time.
-         * @return true if the period has elapsed, false otherwise.
-         */
-        bool period_elapsed(unsigned long int currentTime);
-        
         /**
          * @brief Checks if the task is stuck based on elapsed time, status, and result.
          * 
@@ -136,6 +213,8 @@ class task {
         /**
          * @brief Checks if the task's input is full.
          * 
+         * Only the inputs that were not seen readable since the last run of the task are probed.
+         * 
          * @param t Pointer to the task object.
          * @return true if all inputs are ready to be read; false otherwise.
          */
@@ -147,16 +226,60 @@ class task {
         void print_core_runs();
 
         /**
-         * @brief Adds a file descriptor to the list of inputs.
+         * @brief Adds a pipe to the input table.
          *          
-         * @param fd File descriptor to add.
+         * @param p Pipe to add.
+         * @param size The size of a message.
          */
         void add_input(Pipe *p, int size);
 
+        /**
+         * @brief Adds a shared memory channel to the input table.
+         *          
+         * @param c Channel to add, its readiness is checked in memory instead of with poll().
+         */
+        void add_input(Channel *c, int size);
+
+        /**
+         * @brief Adds a pipe to the list of outputs.
+         *
+         * Declare every pipe and channel the task function writes to: when a run ends the scheduler only
+         * checks the consumers of the outputs of the task (and the tasks whose inputs sent an event). A
+         * channel without a notify fd (EVENT_DRIVEN not defined) sends no event, so a consumer of an
+         * undeclared channel is checked on every pass instead. If SIMULATION is defined a successful run
+         * also adds a token to each output, which makes the inputs of the consuming tasks full.
+         *
+         * @param p Pipe the task function writes to.
+         */
+        void add_output(Pipe *p);
+
+        /**
+         * @brief Adds a shared memory channel to the list of outputs, see add_output(Pipe*).
+         */
+        void add_output(Channel *c);
+
+        output* get_outputs() { return m_outputs; }
+
+        /**
+         * @brief Consumes one simulated message from each input.
+         */
+        void take_input_tokens();
+
+        /**
+         * @brief Produces one simulated message on each output.
+         */
+        void add_output_tokens();
+
+        /**
+         * @brief Frees the outputs, the scheduler deletes voters through their task pointer.
+         */
+        virtual ~task();
+
         // TODO: Add comments
         static task* declare_task(const string& name, unsigned long int period, unsigned long int offset, int priority, void (*function)(void));
 
         void increment_runs() { m_runs++; }
+        void set_runs(int runs) { m_runs = runs; }
         int get_runs() { return m_runs; }
 
         string get_name() { return m_name; }
@@ -177,13 +300,29 @@ class task {
         pid_t get_pid() { return m_pid; }
         void set_pid(pid_t p) { m_pid = p; }
 
-        void run() { if(m_function != NULL ) m_function(); }
+        int get_id() { return m_id; }
+        void set_id(int id) { m_id = id; m_inputs.set_owner(id); }
+
+        /**
+         * @brief Runs the task function.
+         * 
+         * @return The status passed to task_exit(), or EXIT_SUCCESS if the function returned.
+         */
+        int run();
+
+        /**
+         * @brief Returns the task whose function runs in this process, NULL in the scheduler.
+         *
+         * Lets one function serve many tasks, e.g. the generated tasks of a workload (see workload.h).
+         */
+        static task* get_current() { return s_current; }
+
+        void set_ballot(ballot *b) { m_ballot = b; }
+        ballot* get_ballot() { return m_ballot; }
 
         void set_startTime(unsigned long int startTime) { m_startTime = startTime; }
 
-        input* get_inputs() { return m_inputs; }
-        input*& get_inputs_ref() { return m_inputs; }
-        void set_inputs(input* in) { m_inputs = in; }
+        input_table& get_inputs() { return m_inputs; }
 
         int get_success() { return m_success; }
         void set_success(int success) { m_success = success; }
@@ -195,6 +334,9 @@ class task {
         int get_errors() { return m_errors; }
         void increment_errors() { m_errors++; }
 
+        int get_cancelled() { return m_cancelled; }
+        void increment_cancelled() { m_cancelled++; }
+
         int get_input_errors() const { return m_inputErrors; }
         void increment_input_errors() { m_inputErrors++; }
 
@@ -227,12 +369,70 @@ class task {
             return state;
         }
 
+        bool get_released() { return m_released; }
+        void set_released(bool released) { m_released = released; }
+
+        bool get_offset_elapsed() { return m_offsetElapsed; }
+        void set_offset_elapsed(bool elapsed) { m_offsetElapsed = elapsed; }
+
+        bool get_stuck_check() { return m_stuckCheck; }
+        void set_stuck_check(bool check) { m_stuckCheck = check; }
+
+        unsigned long int get_startTime() { return m_startTime; }
+
+        int get_pidfd() { return m_pidfd; }
+        void set_pidfd(int pidfd) { m_pidfd = pidfd; }
+        event_source* get_exit_event() { return &m_exitEvent; }
+
         void set_latest(int status, pid_t result) { m_latestStatus = status; m_latestResult = result; }
         int get_latestStatus() { return m_latestStatus; }
         pid_t get_latestResult() { return m_latestResult; }
 
         void add_core_run(int core) { m_coreRuns[core]++; };
 
+        /**
+         * @brief Sets the cost model used by the simulation.
+         *
+         * @param mean Mean execution time in milliseconds.
+         * @param jitter Max deviation from the mean in milliseconds.
+         * @param fault_rate Probability that a run fails.
+         */
+        void set_cost(int mean, int jitter, double fault_rate) { m_cost = { mean, jitter, fault_rate }; }
+        const task_cost& get_cost() { return m_cost; }
+
+        bool get_sim_done() { return m_simDone; }
+        void set_sim_done(bool done) { m_simDone = done; }
+        int get_sim_status() { return m_simStatus; }
+        void set_sim_status(int status) { m_simStatus = status; }
+
+        /**
+         * @brief Timestamps of a run in nanoseconds, they feed the latency histograms.
+         *
+         * mark_released() is called when the period of the task elapses, mark_ready() every time the task
+         * is found fireable (only the first call per run counts), mark_dispatched() when the run starts and
+         * mark_completed() when it ends. Cancelled runs are not marked completed. A run without a release
+         * of its own (e.g. a task triggered by its inputs) is released when it becomes fireable.
+         */
+        void mark_released(uint64_t now) { m_releaseNs = now; }
+        void mark_ready(uint64_t now) { if (!m_readyNs) m_readyNs = now; }
+        void mark_dispatched(uint64_t now);
+        void mark_completed(uint64_t now);
+
+        const latency_histogram& get_latency(latency_metric metric) { return m_latency[metric]; }
+
+        perf_counters& get_perf() { return m_perf; }
+        const counter_totals& get_counters() { return m_counters; }
+        void add_job_counters(const counter_totals &job) { add_counters(m_counters, job); }
+
+        /**
+         * @brief Passes the resource usage of a reaped job from poll_job() to the completion handling.
+         */
+        void set_job_usage(const job_usage &usage) { m_jobUsage = usage; m_jobUsageValid = true; }
+        bool take_job_usage(job_usage &usage) { usage = m_jobUsage; bool valid = m_jobUsageValid; m_jobUsageValid = false; return valid; }
+
+        const usage_totals& get_usage() { return m_usage; }
+        void add_job_usage(const job_usage &job) { add_usage(m_usage, job); }
+
         string write_core_runs() const ;
 };
 
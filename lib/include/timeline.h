@@ -0,0 +1,112 @@
+/**
+ * @file timeline.h
+ * @brief This file contains the event timeline of the scheduler (if EVENT_TRACE is defined).
+ *
+ * Every release, dispatch, completion, crash, stuck job, cancelled job, vote and log sample is stored
+ * as a fixed-size record in a ring that is allocated before the scheduler starts. Recording is a few
+ * stores, when the ring is full the oldest records are overwritten. The ring is not inherited by the
+ * forked jobs, so it does not make fork() any slower. When the scheduler stops the ring
+ * is exported as Chrome trace JSON (trace.json), which can be opened in Perfetto or chrome://tracing:
+ * one track per core and per task, a dispatch and its completion become one slice on both.
+ */
+
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "defines.h"
+
+using namespace std;
+
+class task;
+
+enum timeline_event {
+    timeline_release,
+    timeline_dispatch,
+    timeline_completion,                    // Value: the waitpid status
+    timeline_crash,                         // Value: the waitpid status
+    timeline_stuck,
+    timeline_cancel,
+    timeline_vote,                          // Value: the number of laggards
+    timeline_log,
+};
+
+typedef struct timeline_record {
+    uint64_t time;                          // Nanoseconds, see scheduler::current_time_in_ns()
+    int32_t value;
+    int32_t task;                           // -1 if the event has no task
+    int16_t core;                           // -1 if the event has no core
+    uint8_t type;
+} timeline_record;
+
+static_assert(MAX_CORES <= INT16_MAX, "a core ID has to fit the core of a timeline record");
+
+class timeline {
+    private:
+        timeline_record *m_ring { NULL };
+        size_t m_slots { 0 };
+        size_t m_next { 0 };                // Slot of the next record
+        size_t m_count { 0 };
+        uint64_t m_overwritten { 0 };
+        uint64_t m_start { 0 };
+
+    public:
+        ~timeline();
+
+        /**
+         * @brief Allocates the ring, call once before the first record.
+         *
+         * @param slots The max number of records, older records are overwritten.
+         * @param start The time of the start of the scheduler, the exported timestamps are relative to it.
+         */
+        void init(size_t slots, uint64_t start);
+
+        /**
+         * @brief Stores one event.
+         *
+         * @param time The time of the event in nanoseconds.
+         * @param type The event.
+         * @param task The ID of the task, -1 if none.
+         * @param core The core, -1 if none.
+         * @param value The status or count that belongs to the event.
+         */
+        void record(uint64_t time, timeline_event type, int task, int core, int value)
+        {
+            if (m_ring == NULL)
+                return;
+
+            timeline_record &r = m_ring[m_next];
+            r.time = time;
+            r.value = value;
+            r.type = type;
+            r.core = core;
+            r.task = task;
+
+            if (++m_next == m_slots)
+                m_next = 0;
+
+            if (m_count < m_slots)
+                m_count++;
+            else
+                m_overwritten++;
+        }
+
+        /**
+         * @brief Writes the stored records as Chrome trace JSON.
+         *
+         * @param path The path of the JSON file.
+         * @param tasks The tasks of the scheduler, indexed by task ID.
+         * @param cores The number of cores.
+         * @return true if the file was written; false otherwise.
+         */
+        bool write_json(const string &path, const vector<task*> &tasks, int cores);
+
+        size_t size() { return m_count; }
+        uint64_t get_overwritten() { return m_overwritten; }
+};
+
+#endif
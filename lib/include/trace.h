@@ -0,0 +1,170 @@
+/**
+ * @file trace.h
+ * @brief This file contains the compact binary trace format of the scheduler results.
+ *
+ * A trace file starts with a trace_header and one TRACE_NAME_SIZE byte name per task, followed by
+ * framed blocks. Every block starts with a trace_frame that holds its type, the number of samples,
+ * the payload size and a checksum, so a reader can mmap the file and walk (or skip) blocks without
+ * decoding them. Sample blocks are self-contained: the first sample of a block is stored against an
+ * all-zero base and every next sample against the previous one. A block is written when it holds
+ * TRACE_BLOCK_SAMPLES samples or when the writer flushes, so blocks may hold fewer samples.
+ *
+ * A sample is encoded as the time delta (varint), a bitmap with one bit per field (core runs, core
+ * weights, task successes) that changed, and a zigzag varint delta per changed field. Weights are
+ * quantized to 1/TRACE_WEIGHT_SCALE. A trace ends with a summary block (the text of summary.txt)
+ * and an end block. The tool in tools/ converts a trace back into the .tsv files and summary.txt.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#define TRACE_MAGIC 0x52544e52              // "RNTR"
+#define TRACE_VERSION 1
+#define TRACE_FRAME_MAGIC 0x4b4c4254        // "TBLK"
+#define TRACE_NAME_SIZE 32
+#define TRACE_WEIGHT_SCALE 100              // Weights are stored in steps of 0.01
+#define TRACE_BLOCK_SAMPLES 1024            // Max number of samples per block
+
+enum trace_frame_type {
+    trace_samples = 1,
+    trace_summary = 2,
+    trace_end = 3,
+};
+
+typedef struct trace_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t cores;
+    uint16_t tasks;
+    uint16_t weight_scale;
+    uint32_t reserved;
+} trace_header;
+
+typedef struct trace_frame {
+    uint32_t magic;
+    uint8_t type;
+    uint8_t reserved;
+    uint16_t count;                         // Number of samples in the block
+    uint32_t size;                          // Size of the payload in bytes
+    uint32_t checksum;                      // FNV-1a over the payload (see message.h)
+} trace_frame;
+
+/**
+ * @brief One decoded sample, the vectors have one entry per core or task.
+ */
+typedef struct trace_sample {
+    long time;
+    vector<int> core_runs;
+    vector<float> weights;
+    vector<int> task_success;
+} trace_sample;
+
+class trace_writer {
+    private:
+        FILE *m_file { NULL };
+        size_t m_numCores { 0 };
+        size_t m_numTasks { 0 };
+        vector<uint8_t> m_block;            // Payload of the open sample block
+        uint16_t m_count { 0 };
+        long m_prevTime { 0 };
+        vector<int64_t> m_prev;             // Previous value of each field: core runs, quantized weights, task successes
+        vector<int64_t> m_delta;
+
+        void write_frame(uint8_t type, uint16_t count, const void *payload, size_t size);
+        void flush_block();
+
+    public:
+        /**
+         * @brief Creates a trace file and writes its header.
+         *
+         * @param path The path of the trace file.
+         * @param names The names of the tasks.
+         * @param cores The number of cores.
+         * @return true if the file was created; false otherwise.
+         */
+        bool open(const string &path, const vector<string> &names, size_t cores);
+
+        /**
+         * @brief Appends a sample, a full block is written to the file.
+         *
+         * @param time The time of the sample in milliseconds.
+         * @param core_runs The runs of each core.
+         * @param weights The weight of each core.
+         * @param task_success The successful runs of each task.
+         */
+        void add_sample(long time, const int *core_runs, const float *weights, const int *task_success);
+
+        /**
+         * @brief Writes the open block, the summary block and the end block and closes the file.
+         *
+         * @param summary The text of summary.txt, may be NULL.
+         * @param size The size of the summary.
+         */
+        void close(const char *summary, size_t size);
+
+        /**
+         * @brief Writes the open block, even if it is not full, and hands the blocks to the kernel.
+         *
+         * A crash after a flush loses none of the samples added before it.
+         */
+        void flush();
+
+        bool is_open() { return m_file != NULL; }
+};
+
+class trace_reader {
+    private:
+        const uint8_t *m_data { NULL };
+        size_t m_size { 0 };
+        size_t m_offset { 0 };              // Offset of the next frame
+        trace_header m_header;
+        vector<string> m_names;
+
+        const uint8_t *m_cursor { NULL };   // Next sample in the current sample block
+        uint16_t m_remaining { 0 };
+        vector<int64_t> m_prev;
+        long m_prevTime { 0 };
+
+        const char *m_summary { NULL };
+        size_t m_summarySize { 0 };
+
+        bool next_block();
+
+    public:
+        ~trace_reader();
+
+        /**
+         * @brief Maps a trace file and checks its header.
+         *
+         * @param path The path of the trace file.
+         * @return true if the file is a valid trace; false otherwise.
+         */
+        bool open(const string &path);
+
+        /**
+         * @brief Decodes the next sample.
+         *
+         * @param sample The decoded sample.
+         * @return true if a sample was decoded; false at the end of the trace or on a corrupt block.
+         */
+        bool next_sample(trace_sample &sample);
+
+        /**
+         * @brief Returns the summary of the trace, only valid after all samples were read.
+         */
+        const char* get_summary(size_t &size) { size = m_summarySize; return m_summary; }
+
+        size_t get_cores() { return m_header.cores; }
+        size_t get_tasks() { return m_header.tasks; }
+        const vector<string>& get_names() { return m_names; }
+};
+
+#endif
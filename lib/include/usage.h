@@ -0,0 +1,46 @@
+/**
+ * @file usage.h
+ * @brief This file contains the resource usage the kernel reports for every job.
+ *
+ * A forked job is reaped with wait4(), which returns its rusage with the exit status in the same
+ * syscall. A job on a persistent worker (if WORKER_POOL is defined) is measured by the worker with
+ * getrusage() around the job and sent along with its status. The usage is summed per task and core.
+ */
+
+#ifndef USAGE_H
+#define USAGE_H
+
+#include <stdint.h>
+#include <sys/resource.h>
+
+typedef struct job_usage {
+    uint64_t user_us;                       // User CPU time in microseconds
+    uint64_t system_us;                     // System CPU time in microseconds
+    uint64_t minor_faults;
+    uint64_t major_faults;
+    uint64_t voluntary_switches;            // The job blocked, e.g. on a pipe
+    uint64_t involuntary_switches;          // The job was preempted
+} job_usage;
+
+/**
+ * @brief Sums of the usage of the jobs of a task or core.
+ */
+typedef struct usage_totals {
+    uint64_t jobs;
+    job_usage usage;
+} usage_totals;
+
+/**
+ * @brief Returns the usage of a job from its rusage, or from the difference of two rusage samples.
+ *
+ * @param after The rusage of the job, or the rusage of the process after the job.
+ * @param before NULL, or the rusage of the process before the job.
+ */
+job_usage usage_from_rusage(const struct rusage &after, const struct rusage *before);
+
+/**
+ * @brief Adds the usage of one job to the totals of a task or core.
+ */
+void add_usage(usage_totals &totals, const job_usage &job);
+
+#endif
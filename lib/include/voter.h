@@ -17,17 +17,65 @@ class voter : public task {
         vector<replicate> m_replicateMonitor;
         bool m_armed {false};
         voter_type m_voter_type;
+        int m_quorum {0};                   // Number of successful replicates needed to fire, 0 waits for all of them
+        int m_votes {0};
+        int m_earlyVotes {0};               // Votes fired while replicates were still running
+        int m_laggards {0};                 // Replicates that were still running when the voter fired
+        vector<task*> m_lastLaggards;       // The laggards of the latest vote
+        bool m_deferred {false};            // The latest vote found no core, it fires on the next check
+
+        /**
+         * @brief Returns the largest number of finished replicates whose ballots of their current run agree.
+         */
+        int count_agreeing();
+
+        /**
+         * @brief Returns whether replicate i finished successfully and cast a ballot in its current run.
+         */
+        bool finished_with_ballot(size_t i);
 
     public:
         voter(const string& name, int period, int offset, int priority, void (*function)(void), voter_type type);
         static voter* declare_voter(const string& name, int period, int offset, int priority, void (*function)(void), voter_type type);
         bool check_replicate_state(task_state state);
+        /**
+         * @brief Adds a replicate and gives it a ballot in shared memory, call before the jobs are forked.
+         */
         void add_replicate(task *t);
+        const vector<task*>& get_replicates() { return m_replicates; }
         bool get_voter_fireable();
         void set_armed(bool armed) { m_armed = armed; }
         bool get_armed() { return m_armed; }
         void set_voter_type(voter_type type) { m_voter_type = type; }
         voter_type get_voter_type() { return m_voter_type; }
+
+        /**
+         * @brief Enables early voting: the voter fires as soon as k replicates finished successfully with the same output.
+         *
+         * The outputs are compared on the ballots the replicates cast with task_vote(): k of them need the same
+         * chain and digest. As long as the finished replicates disagree, or did not cast a ballot, the voter
+         * waits for all replicates. Replicates that are still running when it fires (laggards) finish in the
+         * background. They are not counted towards the next round until they have been dispatched again.
+         *
+         * @param quorum The number of successful replicates needed, 0 waits for all replicates.
+         */
+        void set_quorum(int quorum) { m_quorum = quorum; }
+        int get_quorum() { return m_quorum; }
+        int get_votes() { return m_votes; }
+        int get_early_votes() { return m_earlyVotes; }
+        int get_laggards() { return m_laggards; }
+
+        /**
+         * @brief Returns the replicates that were still running when the voter fired the last time.
+         */
+        const vector<task*>& get_last_laggards() { return m_lastLaggards; }
+
+        /**
+         * @brief Keeps the latest vote when the voter found no core, the next get_voter_fireable() returns true again.
+         *
+         * The vote is not counted again and its laggards stay the laggards of the vote.
+         */
+        void defer_vote() { m_deferred = true; }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,113 @@
+/**
+ * @file worker.h
+ * @brief This file contains the persistent, pinned worker processes used when WORKER_POOL is defined.
+ *
+ * Every managed core gets one long-lived worker process. The scheduler sends job descriptors over
+ * a control pipe and the worker reports the exit status of the job over a status pipe, so a job
+ * no longer costs a fork(), sched_setaffinity() and prctl(). A worker that crashes or hangs is
+ * replaced; its job is accounted for as a failure exactly like a crashed forked child.
+ */
+
+#ifndef WORKER_H
+#define WORKER_H
+
+#include <sys/types.h>
+#include <vector>
+
+#include "defines.h"
+#include "task.h"
+#include "usage.h"
+#include "event_loop.h"
+
+using namespace std;
+
+typedef struct job_descriptor {
+    int task_id;
+    int run;                // The run of the task, the copy of the task in the worker is older
+} job_descriptor;
+
+typedef struct job_report {
+    int task_id;
+    int status;             // Encoded like a waitpid() status
+    job_usage usage;        // Resource usage of the worker during the job
+} job_report;
+
+class worker {
+    private:
+        int m_coreID;
+        pid_t m_pid { -1 };
+        int m_control_fd { -1 };    // Write end, scheduler -> worker
+        int m_status_fd { -1 };     // Read end, worker -> scheduler
+        int m_pidfd { -1 };
+        bool m_alive { false };
+        int m_spawns { 0 };
+        task *m_job { NULL };
+
+        event_source m_exitEvent { child_exit, this };
+        event_source m_statusEvent { worker_status, this };
+
+        static vector<int> s_schedulerFds;  // The scheduler ends of the pipes of every live worker, closed in a new worker
+
+        /**
+         * @brief Removes a descriptor of a killed worker from s_schedulerFds.
+         */
+        static void forget_fd(int fd);
+
+        /**
+         * @brief The main loop of the worker process, never returns.
+         *
+         * @param tasks The task list of the scheduler, job descriptors index into this list.
+         * @param control_fd The read end of the control pipe.
+         * @param status_fd The write end of the status pipe.
+         */
+        void worker_loop(vector<task*> &tasks, int control_fd, int status_fd);
+
+    public:
+        worker(int coreID);
+
+        static worker* declare_worker(int coreID);
+
+        /**
+         * @brief Forks the worker process and pins it to its core.
+         *
+         * @param tasks The task list of the scheduler.
+         * @param events The event loop to register the worker with, may be NULL.
+         *
+         * Exits the program if the pipes cannot be created or the fork fails.
+         */
+        void spawn(vector<task*> &tasks, event_loop *events);
+
+        /**
+         * @brief Sends a job to the worker.
+         *
+         * @param t The task to run.
+         * @return The process ID of the worker, or -1 if the job could not be sent.
+         */
+        pid_t dispatch(task *t);
+
+        /**
+         * @brief Checks whether the current job finished or the worker died.
+         *
+         * @param status Set to the (waitpid encoded) status of the job or the dead worker.
+         * @param usage Set to the resource usage of the job, unchanged if the worker died.
+         * @return 0 if the job is still running, otherwise the process ID of the worker.
+         */
+        pid_t poll(int *status, job_usage *usage);
+
+        /**
+         * @brief Kills the worker (e.g. when its job is stuck) and reaps it.
+         *
+         * @param events The event loop the worker is registered with, may be NULL.
+         */
+        void kill_worker(event_loop *events);
+
+        int get_coreID() { return m_coreID; }
+        pid_t get_pid() { return m_pid; }
+        bool get_alive() { return m_alive; }
+        int get_spawns() { return m_spawns; }
+
+        task* get_job() { return m_job; }
+        void set_job(task *t) { m_job = t; }
+};
+
+#endif
@@ -0,0 +1,123 @@
+/**
+ * @file workload.h
+ * @brief This file contains the generator of synthetic task graphs for scaling experiments.
+ *
+ * A workload is a DAG of stages drawn from a seed. The stages of the first layer are periodic sources,
+ * every other stage reads the output of 1 to max_fan_in earlier stages: of the previous layer if the
+ * graph is layered, of any earlier stage otherwise. A stage feeds at most max_fan_out stages, unless a
+ * stage would otherwise have no input. A share of the non-source stages is replicated: the stage runs as
+ * a number of replicates, each with its own copy of the inputs, and a voter passes their result on.
+ *
+ * Every generated task has a cost (mean ± jitter milliseconds and a fault rate). A real run busy-waits
+ * the cost in the task function, a simulated run samples it (if SIMULATION is defined). The task
+ * functions move an 8 byte token through the pipes, so the readiness of the stages follows the graph.
+ */
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+#include "defines.h"
+#include "scheduler.h"
+#include "pipe.h"
+
+using namespace std;
+
+typedef struct workload_params {
+    unsigned int seed { WORKLOAD_SEED };
+    int stages { 100 };                             // Number of stages, a replicated stage is one stage
+#ifdef WORKLOAD_RANDOM
+    bool layered { false };
+#else
+    bool layered { true };
+#endif
+    int layers { WORKLOAD_LAYERS };
+    int max_fan_in { WORKLOAD_MAX_FAN_IN };
+    int max_fan_out { WORKLOAD_MAX_FAN_OUT };
+    vector<unsigned long> periods WORKLOAD_PERIODS;
+    int replicas { WORKLOAD_REPLICAS };
+    double replicated { WORKLOAD_REPLICATED };
+    int cost_mean { WORKLOAD_COST_MEAN };
+    int cost_jitter { WORKLOAD_COST_JITTER };
+    double fault_rate { WORKLOAD_FAULT_RATE };
+} workload_params;
+
+typedef struct workload_stage {
+    int layer;                                      // The depth of the stage, 0 for the sources
+    unsigned long period;                           // 0 for the data-driven stages
+    vector<int> inputs;                             // The stages this stage reads from
+    int consumers;                                  // The number of stages that read from this stage
+    bool replicated;
+} workload_stage;
+
+/**
+ * @brief The task function of a stage: reads the newest token of every input, busy-waits the cost of the
+ * task and writes the token to every output.
+ */
+void workload_job();
+
+/**
+ * @brief The task function of a voter: reads the newest token of every replicate, busy-waits the cost of
+ * the voter and writes a token to every output. Fails if no replicate wrote a token.
+ */
+void workload_vote();
+
+class workload {
+    private:
+        workload_params m_params;
+        vector<workload_stage> m_stages;
+        vector<task*> m_producers;                  // The task (or voter) that writes the output of each stage
+        vector<Pipe*> m_pipes;
+        int m_tasks { 0 };
+        int m_voters { 0 };
+
+        workload(const workload_params &params);
+
+        void generate();
+        Pipe* connect(task *producer, task *consumer, const string &name);
+
+    public:
+        /**
+         * @brief Draws a task graph, nothing is declared yet.
+         *
+         * @param params The shape, size, seed and costs of the graph.
+         * @return Pointer to the workload.
+         */
+        static workload* declare_workload(const workload_params &params);
+
+        /**
+         * @brief Declares the tasks, voters and pipes of the graph and adds them to a scheduler.
+         *
+         * The tasks are added in stage order, so the first task (which ends an ITERATION_BASED run) is a source.
+         * If SIMULATION is defined the pipes only count tokens, no descriptors are created.
+         *
+         * @param s The scheduler, its cores are initialized.
+         */
+        void build(scheduler *s);
+
+        /**
+         * @brief Closes the descriptors of the pipes, call after the scheduler was cleaned up.
+         */
+        void close_pipes();
+
+        /**
+         * @brief Writes the graph as a graph file (see graph.h), which loads into the same tasks, voters and pipes as build().
+         *
+         * @param file The stream to write to.
+         */
+        void write_graph(FILE *file);
+
+        const vector<workload_stage>& get_stages() { return m_stages; }
+        int get_tasks() { return m_tasks; }
+        int get_voters() { return m_voters; }
+
+        /**
+         * @brief Returns the number of pipes build() declares, known before the graph is built.
+         */
+        size_t get_pipes();
+};
+
+#endif
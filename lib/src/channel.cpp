@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+
+#include <channel.h>
+
+Channel::Channel(channel_ring *ring, int notify_fd, const char *name)
+{
+    m_ring = ring;
+    m_notify_fd = notify_fd;
+    m_name = strdup(name);
+}
+
+Channel* Channel::declare_channel(const char *name)
+{
+    int memfd = memfd_create(name, MFD_CLOEXEC);
+    if (memfd == -1)
+    {
+        perror("memfd_create");
+        exit(EXIT_FAILURE);
+    }
+
+    if (ftruncate(memfd, sizeof(channel_ring)) == -1)
+    {
+        perror("ftruncate");
+        exit(EXIT_FAILURE);
+    }
+
+    void *memory = mmap(NULL, sizeof(channel_ring), PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (memory == MAP_FAILED)
+    {
+        perror("mmap");
+        exit(EXIT_FAILURE);
+    }
+
+    // The mapping stays valid (and shared with forked tasks) without the descriptor
+    close(memfd);
+
+    channel_ring *ring = new (memory) channel_ring();
+    ring->head.store(0, std::memory_order_relaxed);
+    ring->tail.store(0, std::memory_order_relaxed);
+
+    for (int i = 0; i < CHANNEL_SLOTS; i++)
+        ring->slots[i].sequence.store(0, std::memory_order_relaxed);
+
+    int notify_fd = -1;
+
+#ifdef EVENT_DRIVEN
+    notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (notify_fd == -1)
+    {
+        perror("eventfd");
+        exit(EXIT_FAILURE);
+    }
+#endif
+
+    Channel *c = new Channel(ring, notify_fd, name);
+    return c;
+}
+
+bool Channel::write_raw(const void *buffer, size_t size)
+{
+    if (size > CHANNEL_SLOT_SIZE)
+        return false;
+
+    uint64_t head = m_ring->head.load(std::memory_order_relaxed);
+
+    if (head - m_ring->tail.load(std::memory_order_acquire) >= CHANNEL_SLOTS)
+        return false;
+
+    channel_slot *slot = &m_ring->slots[head % CHANNEL_SLOTS];
+    memcpy(slot->data, buffer, size);
+    slot->size = size;
+    slot->sequence.store(head + 1, std::memory_order_release);
+
+    m_ring->head.store(head + 1, std::memory_order_release);
+
+    if (m_notify_fd >= 0)
+        eventfd_write(m_notify_fd, 1);
+
+    return true;
+}
+
+size_t Channel::read_raw(void *buffer, size_t size)
+{
+    uint64_t tail = m_ring->tail.load(std::memory_order_relaxed);
+
+    if (m_ring->head.load(std::memory_order_acquire) == tail)
+        return 0;
+
+    channel_slot *slot = &m_ring->slots[tail % CHANNEL_SLOTS];
+
+    // The sequence number has to match the message we expect, otherwise the slot is not published yet
+    if (slot->sequence.load(std::memory_order_acquire) != tail + 1)
+        return 0;
+
+    size_t message_size = slot->size;
+    memcpy(buffer, slot->data, message_size < size ? message_size : size);
+
+    m_ring->tail.store(tail + 1, std::memory_order_release);
+
+    return message_size;
+}
+
+bool Channel::write_data(const char *buffer)
+{
+    return write_raw(buffer, strlen(buffer) + 1);
+}
+
+bool Channel::read_data(char *buffer, size_t buf_size)
+{
+    size_t num_bytes = read_raw(buffer, buf_size - 1);
+
+    if (num_bytes == 0)
+        return false;
+
+    buffer[num_bytes < buf_size - 1 ? num_bytes : buf_size - 1] = '\0';
+    return true;
+}
@@ -0,0 +1,221 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <ctype.h>
+#include <sched.h>
+#include <algorithm>
+
+#include <config.h>
+
+run_config CONFIG;
+
+typedef struct config_param {
+    const char *key;
+    const char *description;
+    long min;
+    long max;
+    int run_config::*value;                     // The parameter if it is an int
+    long run_config::*value_long;               // The parameter if it is a long
+} config_param;
+
+static const config_param params[] = {
+    { "cores", "number of cores that run tasks", 1, MAX_CORES, &run_config::cores, NULL },
+    { "scheduler_core", "core the scheduler runs on", 0, MAX_CORES, &run_config::scheduler_core, NULL },
+    { "cpu_base", "CPU of core 0", 0, CPU_SETSIZE - 1, &run_config::cpu_base, NULL },
+    { "buffer_size", "results a core weight is averaged over", 1, 1000, &run_config::buffer_size, NULL },
+    { "stuck_time", "max time (ms) a task may stay in the same state", 1, 3600000, &run_config::stuck_time, NULL },
+    { "busy_time", "time (ms) a task is busy", 0, 3600000, &run_config::busy_time, NULL },
+    { "iterations", "runs of the first task (ITERATION_BASED)", 1, 1000000000, NULL, &run_config::iterations },
+    { "run_time", "run time (ms) (TIME_BASED)", 1, 1000000000, NULL, &run_config::run_time },
+};
+
+static string normalize(const string &key)
+{
+    string result = key;
+    replace(result.begin(), result.end(), '-', '_');
+    return result;
+}
+
+static string trim(const string &text)
+{
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    size_t end = text.find_last_not_of(" \t\r\n");
+
+    return (begin == string::npos) ? "" : text.substr(begin, end - begin + 1);
+}
+
+const char* mode_name(redundancy_mode mode)
+{
+    switch (mode)
+    {
+        case redundancy_mode::nmr:
+            return "NMR";
+        case redundancy_mode::ravnmr:
+            return "RAV-NMR";
+        default:
+            return "baseline";
+    }
+}
+
+// Parses a comma separated list of modes, "all" adds the three modes
+static bool parse_modes(vector<redundancy_mode> &modes, const string &value)
+{
+    vector<redundancy_mode> parsed;
+    size_t begin = 0;
+
+    while (begin <= value.size())
+    {
+        size_t end = value.find(',', begin);
+        if (end == string::npos)
+            end = value.size();
+
+        string mode = trim(value.substr(begin, end - begin));
+        transform(mode.begin(), mode.end(), mode.begin(), ::tolower);
+
+        if (mode == "baseline")
+            parsed.push_back(redundancy_mode::baseline);
+        else if (mode == "nmr")
+            parsed.push_back(redundancy_mode::nmr);
+        else if (mode == "ravnmr" || mode == "rav-nmr")
+            parsed.push_back(redundancy_mode::ravnmr);
+        else if (mode == "all")
+            parsed.insert(parsed.end(), { redundancy_mode::baseline, redundancy_mode::nmr, redundancy_mode::ravnmr });
+        else
+        {
+            fprintf(stderr, "Invalid value for mode: %s (baseline, nmr, ravnmr or all)\n", value.c_str());
+            return false;
+        }
+
+        begin = end + 1;
+    }
+
+    modes = parsed;
+    return true;
+}
+
+bool config_set(run_config &config, const string &key, const string &value)
+{
+    string name = normalize(key);
+
+    if (name == "mode")
+        return parse_modes(config.modes, value);
+
+    if (name == "graph")
+    {
+        config.graph = value;
+        return !value.empty();
+    }
+
+    if (name == "results")
+    {
+        config.results = value;
+        return !value.empty();
+    }
+
+    for (const config_param &p : params)
+    {
+        if (name != p.key)
+            continue;
+
+        char *end = NULL;
+        errno = 0;
+        long number = strtol(value.c_str(), &end, 10);
+
+        if (errno || end == value.c_str() || *end != '\0' || number < p.min || number > p.max)
+        {
+            fprintf(stderr, "Invalid value for %s: %s (%ld to %ld)\n", p.key, value.c_str(), p.min, p.max);
+            return false;
+        }
+
+        if (p.value)
+            config.*p.value = (int)number;
+        else
+            config.*p.value_long = number;
+
+        return true;
+    }
+
+    fprintf(stderr, "Unknown parameter: %s\n", key.c_str());
+    return false;
+}
+
+bool config_load(run_config &config, const string &path)
+{
+    FILE *file = fopen(path.c_str(), "r");
+
+    if (!file)
+    {
+        perror("Failed to open file");
+        return false;
+    }
+
+    char line[512];
+    bool valid = true;
+
+    while (valid && fgets(line, sizeof(line), file))
+    {
+        string text = trim(line);
+
+        if (text.empty() || text[0] == '#')
+            continue;
+
+        size_t equals = text.find('=');
+
+        if (equals == string::npos)
+        {
+            fprintf(stderr, "Expected key = value in %s: %s\n", path.c_str(), text.c_str());
+            valid = false;
+            break;
+        }
+
+        valid = config_set(config, trim(text.substr(0, equals)), trim(text.substr(equals + 1)));
+    }
+
+    fclose(file);
+    return valid;
+}
+
+bool config_parse(run_config &config, int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--", 2) != 0 || i + 1 >= argc)
+        {
+            fprintf(stderr, "Expected --key value: %s\n", argv[i]);
+            return false;
+        }
+
+        string key = argv[i] + 2;
+        string value = argv[++i];
+
+        if (!(key == "config" ? config_load(config, value) : config_set(config, key, value)))
+            return false;
+    }
+
+    if (config.get_width() > MAX_CORES)
+    {
+        fprintf(stderr, "The cores and the scheduler core need more than MAX_CORES (%d) cores\n", MAX_CORES);
+        return false;
+    }
+
+    return true;
+}
+
+void config_usage(FILE *file, const run_config &config)
+{
+    fprintf(file, "  %-34s key = value lines, applied in order with the arguments\n", "--config <file>");
+
+    for (const config_param &p : params)
+    {
+        string option = string("--") + p.key + " <" + to_string(p.min) + ".." + to_string(p.max) + ">";
+        fprintf(file, "  %-34s %s (%ld)\n", option.c_str(), p.description, p.value ? (long)(config.*p.value) : config.*p.value_long);
+    }
+
+    string modes;
+    for (redundancy_mode mode : config.modes)
+        modes += string(modes.empty() ? "" : ",") + mode_name(mode);
+
+    fprintf(file, "  %-34s redundancy modes, a list runs back to back (%s)\n", "--mode <baseline|nmr|ravnmr|all>", modes.c_str());
+    fprintf(file, "  %-34s task graph file to run instead of the modes (%s)\n", "--graph <file>", config.graph.empty() ? "none" : config.graph.c_str());
+    fprintf(file, "  %-34s result directory (%s)\n", "--results <directory>", config.results.empty() ? "results/<name>_<date>.txt" : config.results.c_str());
+}
@@ -1,4 +1,5 @@
 #include "core.h"
+#include "core_index.h"
 
 core::core(int id, float weight, bool active, int runs)
 {
@@ -7,9 +8,9 @@ core::core(int id, float weight, bool active, int runs)
     m_active = active;
     m_runs = runs;
 
-    for (int i = 0; i < CORE_BUFFER_SIZE; i++)
+    for (int i = 0; i < CONFIG.buffer_size; i++)
     {
-        m_scoreBuffer.push(int(100 / CORE_BUFFER_SIZE));
+        m_scoreBuffer.push(int(100 / CONFIG.buffer_size));
     }
 }
 
@@ -20,4 +21,39 @@ void core::update_weight(int result)
 
     m_weight += result;
     m_scoreBuffer.push(result);
+
+    if (m_index)
+        m_index->update(this);
+}
+
+void core::set_weight(float weight)
+{
+    m_weight = weight;
+
+    if (m_index)
+        m_index->update(this);
+}
+
+void core::set_active(bool active)
+{
+    m_active = active;
+
+    if (m_index)
+        m_index->update(this);
+}
+
+void core::set_runs(int runs)
+{
+    m_runs = runs;
+
+    if (m_index)
+        m_index->update(this);
+}
+
+void core::increase_runs()
+{
+    m_runs++;
+
+    if (m_index)
+        m_index->update(this);
 }
\ No newline at end of file
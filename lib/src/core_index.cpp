@@ -0,0 +1,130 @@
+#include <core_index.h>
+#include <core.h>
+
+static bool fewer_runs(core *lhs, core *rhs)
+{
+    if (lhs->get_runs() != rhs->get_runs())
+        return lhs->get_runs() < rhs->get_runs();
+
+    return lhs->get_coreID() < rhs->get_coreID();
+}
+
+static bool more_reliable(core *lhs, core *rhs)
+{
+    if (lhs->get_weight() != rhs->get_weight())
+        return lhs->get_weight() > rhs->get_weight();
+
+    return fewer_runs(lhs, rhs);
+}
+
+core_heap::core_heap(bool (*before)(core *lhs, core *rhs))
+{
+    m_before = before;
+}
+
+void core_heap::swap_nodes(int a, int b)
+{
+    core *tmp = m_heap[a];
+    m_heap[a] = m_heap[b];
+    m_heap[b] = tmp;
+
+    m_position[m_heap[a]->get_coreID()] = a;
+    m_position[m_heap[b]->get_coreID()] = b;
+}
+
+void core_heap::sift_up(int i)
+{
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+
+        if (!m_before(m_heap[i], m_heap[parent]))
+            break;
+
+        swap_nodes(i, parent);
+        i = parent;
+    }
+}
+
+void core_heap::sift_down(int i)
+{
+    int size = m_heap.size();
+
+    while (true)
+    {
+        int first = i;
+        int left = 2 * i + 1;
+        int right = 2 * i + 2;
+
+        if (left < size && m_before(m_heap[left], m_heap[first]))
+            first = left;
+
+        if (right < size && m_before(m_heap[right], m_heap[first]))
+            first = right;
+
+        if (first == i)
+            break;
+
+        swap_nodes(i, first);
+        i = first;
+    }
+}
+
+void core_heap::update(core *c, bool present)
+{
+    int id = c->get_coreID();
+
+    if (id >= (int)m_position.size())
+        m_position.resize(id + 1, -1);
+
+    int i = m_position[id];
+
+    if (i == -1)
+    {
+        if (!present)
+            return;
+
+        m_heap.push_back(c);
+        m_position[id] = m_heap.size() - 1;
+        sift_up(m_heap.size() - 1);
+        return;
+    }
+
+    if (!present)
+    {
+        // Move the last node into the gap
+        int last = m_heap.size() - 1;
+        swap_nodes(i, last);
+        m_heap.pop_back();
+        m_position[id] = -1;
+
+        if (i < last)
+        {
+            sift_up(i);
+            sift_down(i);
+        }
+        return;
+    }
+
+    sift_up(i);
+    sift_down(m_position[id]);
+}
+
+core_index::core_index() : m_byRuns(fewer_runs), m_byWeight(more_reliable)
+{
+
+}
+
+void core_index::add_core(core *c)
+{
+    c->set_index(this);
+    update(c);
+}
+
+void core_index::update(core *c)
+{
+    bool present = !c->get_active();
+
+    m_byRuns.update(c, present);
+    m_byWeight.update(c, present);
+}
@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include <counters.h>
+
+const char *counter_names[NUM_COUNTERS] = { "cycles", "instructions", "llc_misses", "branch_misses", "context_switches", "task_clock" };
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} counter_events[NUM_COUNTERS] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+};
+
+counter_support perf_counters::s_support = counters_unknown;
+bool perf_counters::s_excludeKernel = false;
+
+perf_counters::perf_counters()
+{
+    for (int i = 0; i < NUM_COUNTERS; i++)
+        m_fds[i] = -1;
+}
+
+int perf_counters::open_event(int counter, pid_t pid, int group)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+
+    attr.size = sizeof(attr);
+    attr.type = counter_events[counter].type;
+    attr.config = counter_events[counter].config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = s_excludeKernel;
+    attr.exclude_hv = 1;
+
+    int fd = syscall(SYS_perf_event_open, &attr, pid, -1, group, PERF_FLAG_FD_CLOEXEC);
+
+    // Without the rights to count the kernel (perf_event_paranoid), count user space only from now on
+    if (fd == -1 && errno == EACCES && !s_excludeKernel)
+    {
+        s_excludeKernel = true;
+        attr.exclude_kernel = 1;
+        fd = syscall(SYS_perf_event_open, &attr, pid, -1, group, PERF_FLAG_FD_CLOEXEC);
+    }
+
+    return fd;
+}
+
+bool perf_counters::open(pid_t pid)
+{
+    close();
+
+    if (s_support == counters_none)
+        return false;
+
+    for (int i = 0; i < NUM_COUNTERS; i++)
+    {
+        if (s_support == counters_software && counter_events[i].type == PERF_TYPE_HARDWARE)
+            continue;
+
+        int fd = open_event(i, pid, m_open ? m_fds[m_order[0]] : -1);
+
+        if (fd != -1)
+        {
+            m_fds[i] = fd;
+            m_order[m_open++] = i;
+            continue;
+        }
+
+        // The job already ended, that does not tell what is supported
+        if (errno == ESRCH)
+            break;
+
+        if (s_support != counters_unknown)
+            continue;
+
+        // The first job finds out what is supported, the next jobs do not retry
+        if (counter_events[i].type == PERF_TYPE_HARDWARE)
+        {
+            s_support = counters_software;
+            close();
+            return open(pid);
+        }
+
+        if (!m_open)
+        {
+            fprintf(stderr, "perf_event_open: %s, continuing without counters\n", strerror(errno));
+            s_support = counters_none;
+            return false;
+        }
+    }
+
+    if (s_support == counters_unknown && m_fds[counter_cycles] != -1)
+        s_support = counters_hardware;
+
+    return m_open > 0;
+}
+
+bool perf_counters::read(counter_totals &job)
+{
+    if (!m_open)
+        return false;
+
+    // One read returns the whole group: the number of values followed by the values in the order they were opened
+    uint64_t values[1 + NUM_COUNTERS];
+    ssize_t size = ::read(m_fds[m_order[0]], values, sizeof(values));
+
+    memset(&job, 0, sizeof(job));
+
+    if (size >= (ssize_t)sizeof(uint64_t) && values[0] == (uint64_t)m_open)
+    {
+        job.jobs = 1;
+
+        for (int i = 0; i < m_open; i++)
+            job.value[m_order[i]] = values[1 + i];
+    }
+
+    close();
+    return job.jobs == 1;
+}
+
+void perf_counters::close()
+{
+    for (int i = 0; i < NUM_COUNTERS; i++)
+    {
+        if (m_fds[i] != -1)
+            ::close(m_fds[i]);
+
+        m_fds[i] = -1;
+    }
+
+    m_open = 0;
+}
+
+void add_counters(counter_totals &totals, const counter_totals &job)
+{
+    totals.jobs += job.jobs;
+
+    for (int i = 0; i < NUM_COUNTERS; i++)
+        totals.value[i] += job.value[i];
+}
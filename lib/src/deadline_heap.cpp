@@ -0,0 +1,26 @@
+#include <algorithm>
+
+#include <deadline_heap.h>
+
+static bool later(const deadline_entry &lhs, const deadline_entry &rhs)
+{
+    return lhs.time > rhs.time;
+}
+
+void deadline_heap::push(unsigned long int time, task *t, deadline_type type, int generation)
+{
+    m_heap.push_back({ time, t, type, generation });
+    push_heap(m_heap.begin(), m_heap.end(), later);
+}
+
+bool deadline_heap::pop_expired(unsigned long int currentTime, deadline_entry &entry)
+{
+    if (m_heap.empty() || m_heap.front().time > currentTime)
+        return false;
+
+    pop_heap(m_heap.begin(), m_heap.end(), later);
+    entry = m_heap.back();
+    m_heap.pop_back();
+
+    return true;
+}
@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <sys/mman.h>
+
+#include <e2e.h>
+
+e2e_tracker::e2e_tracker(e2e_shared *shared)
+{
+    m_shared = shared;
+}
+
+e2e_tracker::~e2e_tracker()
+{
+    munmap(m_shared, sizeof(e2e_shared));
+}
+
+e2e_tracker* e2e_tracker::declare_e2e_tracker()
+{
+    void *memory = mmap(NULL, sizeof(e2e_shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        perror("mmap");
+        exit(EXIT_FAILURE);
+    }
+
+    e2e_shared *shared = new (memory) e2e_shared();
+    shared->next_chain.store(0, std::memory_order_relaxed);
+    shared->last_chain.store(0, std::memory_order_relaxed);
+    shared->lost.store(0, std::memory_order_relaxed);
+    shared->repeated.store(0, std::memory_order_relaxed);
+    shared->paths = 0;
+
+    return new e2e_tracker(shared);
+}
+
+uint32_t e2e_tracker::add_path(const char *name)
+{
+    if (m_shared->paths == MAX_E2E_PATHS)
+    {
+        fprintf(stderr, "Too many end-to-end paths, increase MAX_E2E_PATHS\n");
+        exit(EXIT_FAILURE);
+    }
+
+    e2e_path &path = m_shared->path[m_shared->paths++];
+    strncpy(path.name, name, E2E_NAME_SIZE - 1);
+
+    return m_shared->paths;
+}
+
+void e2e_tracker::record(const message_header &header)
+{
+    if (!header.origin || !header.path || header.path > m_shared->paths)
+        return;
+
+    m_shared->path[header.path - 1].latency.record(message_clock() - header.origin);
+
+    // Chains are consumed in order, a gap is a sample that got lost on the way
+    uint32_t last = m_shared->last_chain.load(std::memory_order_relaxed);
+
+    if (header.chain <= last)
+        m_shared->repeated.fetch_add(1, std::memory_order_relaxed);
+    else
+    {
+        m_shared->lost.fetch_add(header.chain - last - 1, std::memory_order_relaxed);
+        m_shared->last_chain.store(header.chain, std::memory_order_relaxed);
+    }
+}
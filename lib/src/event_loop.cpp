@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdint.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
+
+#include <event_loop.h>
+#include <input_table.h>
+
+event_loop::event_loop()
+{
+
+}
+
+event_loop::~event_loop()
+{
+    if (m_timer_fd >= 0)
+        close(m_timer_fd);
+
+    if (m_signal_fd >= 0)
+        close(m_signal_fd);
+
+    if (m_epoll_fd >= 0)
+        close(m_epoll_fd);
+}
+
+event_loop* event_loop::declare_event_loop()
+{
+    event_loop* e = new event_loop();
+    e->init();
+
+    return e;
+}
+
+event_loop* event_loop::declare_readiness_set()
+{
+    event_loop* e = new event_loop();
+    e->init_epoll();
+
+    return e;
+}
+
+void event_loop::init_epoll()
+{
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epoll_fd == -1)
+    {
+        perror("epoll_create1");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void event_loop::init()
+{
+    init_epoll();
+
+    m_timer_fd = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (m_timer_fd == -1)
+    {
+        perror("timerfd_create");
+        exit(EXIT_FAILURE);
+    }
+
+    watch_fd(m_timer_fd, &m_timerSource, false);
+
+    // Probe for pidfd support with our own pid
+    int probe = syscall(SYS_pidfd_open, getpid(), 0);
+    if (probe >= 0)
+    {
+        m_pidfd_supported = true;
+        close(probe);
+        return;
+    }
+
+    // Fall back to a signalfd on SIGCHLD
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+
+    if (sigprocmask(SIG_BLOCK, &mask, NULL) == -1)
+    {
+        perror("sigprocmask");
+        exit(EXIT_FAILURE);
+    }
+
+    m_signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (m_signal_fd == -1)
+    {
+        perror("signalfd");
+        exit(EXIT_FAILURE);
+    }
+
+    watch_fd(m_signal_fd, &m_signalSource, false);
+}
+
+int event_loop::watch_child(pid_t pid, event_source *src, bool edge)
+{
+    if (!m_pidfd_supported)
+        return -1;
+
+    int pidfd = syscall(SYS_pidfd_open, pid, 0);
+    if (pidfd == -1)
+    {
+        perror("pidfd_open");
+        return -1;
+    }
+
+    watch_fd(pidfd, src, edge);
+
+    return pidfd;
+}
+
+void event_loop::watch_fd(int fd, event_source *src, bool edge)
+{
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = src;
+
+    if (edge)
+        ev.events |= EPOLLET;
+
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1)
+        perror("epoll_ctl");
+}
+
+void event_loop::unwatch_fd(int fd)
+{
+    if (fd < 0)
+        return;
+
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    close(fd);
+}
+
+void event_loop::arm_timer(long deadline_ms)
+{
+    if (deadline_ms == m_armedDeadline)
+        return;
+
+    struct itimerspec spec = {};
+    spec.it_value.tv_sec = deadline_ms / 1000;
+    spec.it_value.tv_nsec = (deadline_ms % 1000) * 1000000;
+
+    if (timerfd_settime(m_timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) == -1)
+        perror("timerfd_settime");
+
+    m_armedDeadline = deadline_ms;
+}
+
+int event_loop::wait(bool block)
+{
+    int n = epoll_wait(m_epoll_fd, m_events, MAX_EPOLL_EVENTS, block ? -1 : 0);
+
+    if (n == -1)
+    {
+        if (errno != EINTR)
+            perror("epoll_wait");
+
+        return 0;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        event_source *src = static_cast<event_source*>(m_events[i].data.ptr);
+
+        if (src->type == deadline)
+        {
+            uint64_t expirations;
+            if (read(m_timer_fd, &expirations, sizeof(expirations)) > 0)
+                m_armedDeadline = 0;
+        }
+        else if (src->type == child_signal)
+        {
+            struct signalfd_siginfo info;
+            while (read(m_signal_fd, &info, sizeof(info)) > 0) { }
+        }
+        else if (src->type == input_ready)
+        {
+            input_table *inputs = static_cast<input_table*>(src->owner);
+            bool full = inputs->full();
+
+            inputs->set_ready(src->index);
+
+            if (!full && inputs->full())
+                m_filledInputs.push_back(inputs->get_owner());
+        }
+    }
+
+    return n;
+}
+
+void event_loop::reset_child_signals()
+{
+    if (m_pidfd_supported)
+        return;
+
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigprocmask(SIG_UNBLOCK, &mask, NULL);
+}
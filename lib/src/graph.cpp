@@ -0,0 +1,681 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <map>
+#include <set>
+#include <queue>
+#include <functional>
+
+#include <graph.h>
+#include <voter.h>
+#include <workload.h>
+
+typedef struct graph_value {
+    int line;
+    bool list;
+    string text;                                    // A string or a number
+    vector<string> items;                           // The strings of a list
+} graph_value;
+
+typedef struct graph_table {
+    string kind;                                    // "task" or "voter"
+    int line;
+    map<string, graph_value> values;
+} graph_table;
+
+static map<string, graph_job>& jobs()
+{
+    // Constructed on first use, so jobs can be registered before main() as well
+    static map<string, graph_job> registry = {
+        { "workload", workload_job },
+        { "vote", workload_vote },
+    };
+
+    return registry;
+}
+
+void graph::register_job(const string &name, graph_job job)
+{
+    jobs()[name] = job;
+}
+
+static string trim(const string &text)
+{
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    size_t end = text.find_last_not_of(" \t\r\n");
+
+    return (begin == string::npos) ? "" : text.substr(begin, end - begin + 1);
+}
+
+// Removes a comment, a # in a string is kept
+static string strip_comment(const string &text)
+{
+    bool quoted = false;
+
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        if (text[i] == '"')
+            quoted = !quoted;
+        else if (text[i] == '#' && !quoted)
+            return text.substr(0, i);
+    }
+
+    return text;
+}
+
+// Parses a "string", a [list of "strings"] or a bare number
+static bool parse_value(const string &text, graph_value &value)
+{
+    if (text.empty())
+        return false;
+
+    if (text[0] == '"')
+    {
+        if (text.size() < 2 || text.back() != '"' || text.find('"', 1) != text.size() - 1)
+            return false;
+
+        value.text = text.substr(1, text.size() - 2);
+        return true;
+    }
+
+    if (text[0] == '[')
+    {
+        if (text.back() != ']')
+            return false;
+
+        value.list = true;
+        string rest = trim(text.substr(1, text.size() - 2));
+
+        while (!rest.empty())
+        {
+            size_t end = rest.find('"', 1);
+            if (rest[0] != '"' || end == string::npos)
+                return false;
+
+            value.items.push_back(rest.substr(1, end - 1));
+            rest = trim(rest.substr(end + 1));
+
+            // A trailing comma is allowed, like in TOML
+            if (!rest.empty() && rest[0] != ',')
+                return false;
+            if (!rest.empty())
+                rest = trim(rest.substr(1));
+        }
+
+        return true;
+    }
+
+    value.text = text;
+    return true;
+}
+
+static bool parse_file(const string &path, map<string, graph_value> &top, vector<graph_table> &tables)
+{
+    FILE *file = fopen(path.c_str(), "r");
+
+    if (!file)
+    {
+        perror("Failed to open file");
+        return false;
+    }
+
+    char line[4096];
+    int number = 0;
+    bool valid = true;
+
+    while (valid && fgets(line, sizeof(line), file))
+    {
+        number++;
+
+        if (!strchr(line, '\n') && !feof(file))
+        {
+            fprintf(stderr, "%s:%d: the line is longer than %zu characters\n", path.c_str(), number, sizeof(line) - 2);
+            valid = false;
+            break;
+        }
+
+        string text = trim(strip_comment(line));
+
+        if (text.empty())
+            continue;
+
+        if (text[0] == '[')
+        {
+            if (text == "[[task]]" || text == "[[voter]]")
+                tables.push_back(graph_table { text.substr(2, text.size() - 4), number, {} });
+            else
+            {
+                fprintf(stderr, "%s:%d: expected [[task]] or [[voter]]: %s\n", path.c_str(), number, text.c_str());
+                valid = false;
+            }
+
+            continue;
+        }
+
+        size_t equals = text.find('=');
+        graph_value value { number, false, "", {} };
+
+        if (equals == string::npos || !parse_value(trim(text.substr(equals + 1)), value))
+        {
+            fprintf(stderr, "%s:%d: expected key = value: %s\n", path.c_str(), number, text.c_str());
+            valid = false;
+            continue;
+        }
+
+        string key = trim(text.substr(0, equals));
+        map<string, graph_value> &values = tables.empty() ? top : tables.back().values;
+
+        if (!values.insert({ key, value }).second)
+        {
+            fprintf(stderr, "%s:%d: %s is set twice\n", path.c_str(), number, key.c_str());
+            valid = false;
+        }
+    }
+
+    fclose(file);
+    return valid;
+}
+
+// Reads the values of one table and prints what is wrong with them, every error clears m_valid
+class table_reader {
+    private:
+        const string &m_path;
+        const graph_table &m_table;
+        set<string> m_used;
+        bool m_valid { true };
+
+        const graph_value* find(const string &key, bool list)
+        {
+            m_used.insert(key);
+            auto it = m_table.values.find(key);
+
+            if (it == m_table.values.end())
+                return NULL;
+
+            if (it->second.list != list)
+            {
+                error(it->second.line, key + (list ? " must be a list of strings" : " must be a string or a number"));
+                return NULL;
+            }
+
+            return &it->second;
+        }
+
+    public:
+        table_reader(const string &path, const graph_table &table) : m_path(path), m_table(table) {}
+
+        void error(int line, const string &message)
+        {
+            fprintf(stderr, "%s:%d: %s\n", m_path.c_str(), line, message.c_str());
+            m_valid = false;
+        }
+
+        string get_string(const string &key, const string &fallback)
+        {
+            const graph_value *value = find(key, false);
+            return value ? value->text : fallback;
+        }
+
+        vector<string> get_list(const string &key)
+        {
+            const graph_value *value = find(key, true);
+            return value ? value->items : vector<string>();
+        }
+
+        long get_long(const string &key, long fallback, long min, long max)
+        {
+            const graph_value *value = find(key, false);
+
+            if (!value)
+                return fallback;
+
+            char *end = NULL;
+            errno = 0;
+            long number = strtol(value->text.c_str(), &end, 10);
+
+            if (errno || end == value->text.c_str() || *end != '\0' || number < min || number > max)
+            {
+                error(value->line, "invalid value for " + key + ": " + value->text + " (" + to_string(min) + " to " + to_string(max) + ")");
+                return fallback;
+            }
+
+            return number;
+        }
+
+        double get_double(const string &key, double fallback, double min, double max)
+        {
+            const graph_value *value = find(key, false);
+
+            if (!value)
+                return fallback;
+
+            char *end = NULL;
+            errno = 0;
+            double number = strtod(value->text.c_str(), &end);
+
+            if (errno || end == value->text.c_str() || *end != '\0' || number < min || number > max)
+            {
+                error(value->line, "invalid value for " + key + ": " + value->text);
+                return fallback;
+            }
+
+            return number;
+        }
+
+        // Reports the keys that were never read, e.g. a misspelled key
+        bool finish()
+        {
+            for (const auto &entry : m_table.values)
+            {
+                if (!m_used.count(entry.first))
+                    error(entry.second.line, "unknown key for a " + m_table.kind + ": " + entry.first);
+            }
+
+            return m_valid;
+        }
+};
+
+graph* graph::load_graph(const string &path)
+{
+    map<string, graph_value> top;
+    vector<graph_table> tables;
+
+    if (!parse_file(path, top, tables))
+        return NULL;
+
+    graph *g = new graph();
+    bool valid = true;
+
+    // The name of the graph names the scheduler and its result directory
+    graph_table header { "graph", 0, top };
+    table_reader top_reader(path, header);
+    g->m_name = top_reader.get_string("name", "graph");
+    valid &= top_reader.finish();
+
+    if (tables.empty())
+    {
+        fprintf(stderr, "%s: the graph has no tasks\n", path.c_str());
+        delete g;
+        return NULL;
+    }
+
+    // 1) The tasks in file order, with the names of their pipes and replicates
+    size_t count = tables.size();
+    vector<graph_task> declared(count);
+    vector<vector<string>> inputs(count), outputs(count), replicas(count);
+    map<string, int> task_index;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const graph_table &table = tables[i];
+        table_reader reader(path, table);
+        graph_task &t = declared[i];
+        bool is_voter = (table.kind == "voter");
+
+        t.name = reader.get_string("name", "");
+        t.voter = is_voter;
+        t.period = is_voter ? 0 : reader.get_long("period", 0, 0, 1000000000);
+        t.offset = is_voter ? 0 : reader.get_long("offset", 0, 0, 1000000000);
+        t.priority = reader.get_long("priority", -1, 0, 1000000);
+        t.depth = 0;
+        t.input_size = is_voter ? 0 : reader.get_long("input_size", sizeof(uint64_t), 1, PIPE_BUF);
+        t.cost_mean = reader.get_long("cost_mean", is_voter ? 1 : CONFIG.busy_time, 0, 3600000);
+        t.cost_jitter = reader.get_long("cost_jitter", 0, 0, 3600000);
+        t.fault_rate = reader.get_double("fault_rate", 0.0, 0.0, 1.0);
+        t.type = voter_type::standard;
+        t.group = -1;
+
+#ifdef VOTER_QUORUM
+        t.quorum = is_voter ? reader.get_long("quorum", VOTER_QUORUM, 0, 1000) : 0;
+#else
+        t.quorum = is_voter ? reader.get_long("quorum", 0, 0, 1000) : 0;
+#endif
+
+        string job = reader.get_string("job", is_voter ? "vote" : "workload");
+        auto found = jobs().find(job);
+        t.job = (found == jobs().end()) ? NULL : found->second;
+
+        if (!t.job)
+            reader.error(table.line, "unknown job: " + job);
+
+        if (is_voter)
+        {
+            string type = reader.get_string("type", "standard");
+
+            if (type == "weighted")
+                t.type = voter_type::weighted;
+            else if (type != "standard")
+                reader.error(table.line, "unknown voter type: " + type);
+
+            replicas[i] = reader.get_list("replicas");
+        }
+        else
+            inputs[i] = reader.get_list("inputs");
+
+        outputs[i] = reader.get_list("outputs");
+
+        if (t.name.empty())
+            reader.error(table.line, "the " + table.kind + " has no name");
+        else if (!task_index.insert({ t.name, (int)i }).second)
+            reader.error(table.line, "the name " + t.name + " is used twice");
+
+        valid &= reader.finish();
+    }
+
+    // 2) Every pipe has one writer and one reader, or the voter of its writer
+    map<string, int> writer, reader;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        for (const string &pipe : outputs[i])
+        {
+            if (!writer.insert({ pipe, (int)i }).second)
+            {
+                fprintf(stderr, "%s:%d: pipe %s is written by %s and %s\n", path.c_str(), tables[i].line, pipe.c_str(),
+                    declared[writer[pipe]].name.c_str(), declared[i].name.c_str());
+                valid = false;
+            }
+        }
+
+        for (const string &pipe : inputs[i])
+        {
+            if (!reader.insert({ pipe, (int)i }).second)
+            {
+                fprintf(stderr, "%s:%d: pipe %s is read by %s and %s\n", path.c_str(), tables[i].line, pipe.c_str(),
+                    declared[reader[pipe]].name.c_str(), declared[i].name.c_str());
+                valid = false;
+            }
+        }
+    }
+
+    // 3) The replica sets: existing tasks that are not voters and belong to one voter only
+    vector<int> voter_of(count, -1);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!declared[i].voter)
+            continue;
+
+        if (replicas[i].size() < 2)
+        {
+            fprintf(stderr, "%s:%d: voter %s needs at least two replicas\n", path.c_str(), tables[i].line, declared[i].name.c_str());
+            valid = false;
+        }
+
+        if (declared[i].quorum > (int)replicas[i].size())
+        {
+            fprintf(stderr, "%s:%d: the quorum of voter %s is larger than its replica set\n", path.c_str(), tables[i].line, declared[i].name.c_str());
+            valid = false;
+        }
+
+        for (const string &name : replicas[i])
+        {
+            auto it = task_index.find(name);
+
+            if (it == task_index.end() || declared[it->second].voter)
+            {
+                fprintf(stderr, "%s:%d: replica %s of voter %s is not a task\n", path.c_str(), tables[i].line, name.c_str(), declared[i].name.c_str());
+                valid = false;
+            }
+            else if (voter_of[it->second] != -1)
+            {
+                fprintf(stderr, "%s:%d: %s is a replica of %s and %s\n", path.c_str(), tables[i].line, name.c_str(),
+                    declared[voter_of[it->second]].name.c_str(), declared[i].name.c_str());
+                valid = false;
+            }
+            else
+                voter_of[it->second] = i;
+        }
+    }
+
+    // 4) The dangling pipes and the tasks that could never run
+    for (size_t i = 0; i < count; i++)
+    {
+        for (const string &pipe : inputs[i])
+        {
+            if (!writer.count(pipe))
+            {
+                fprintf(stderr, "%s:%d: pipe %s of %s has no writer\n", path.c_str(), tables[i].line, pipe.c_str(), declared[i].name.c_str());
+                valid = false;
+            }
+        }
+
+        for (const string &pipe : outputs[i])
+        {
+            if (voter_of[i] != -1 && reader.count(pipe))
+            {
+                fprintf(stderr, "%s:%d: pipe %s of replica %s is read by %s, the voter reads it\n", path.c_str(), tables[i].line,
+                    pipe.c_str(), declared[i].name.c_str(), declared[reader[pipe]].name.c_str());
+                valid = false;
+            }
+            else if (voter_of[i] == -1 && !reader.count(pipe))
+            {
+                fprintf(stderr, "%s:%d: pipe %s of %s has no reader\n", path.c_str(), tables[i].line, pipe.c_str(), declared[i].name.c_str());
+                valid = false;
+            }
+        }
+
+        if (voter_of[i] != -1 && outputs[i].empty())
+        {
+            fprintf(stderr, "%s:%d: replica %s has no output for its voter\n", path.c_str(), tables[i].line, declared[i].name.c_str());
+            valid = false;
+        }
+
+        if (!declared[i].voter && inputs[i].empty() && declared[i].period == 0)
+        {
+            fprintf(stderr, "%s:%d: %s has no inputs and no period\n", path.c_str(), tables[i].line, declared[i].name.c_str());
+            valid = false;
+        }
+    }
+
+    if (!valid)
+    {
+        delete g;
+        return NULL;
+    }
+
+    // 5) Topological order, ties keep the file order so the first source stays first
+    vector<vector<int>> consumers(count);
+    vector<int> pending(count, 0);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        for (const string &pipe : inputs[i])
+        {
+            consumers[writer[pipe]].push_back(i);
+            pending[i]++;
+        }
+
+        if (voter_of[i] != -1)
+        {
+            consumers[i].push_back(voter_of[i]);
+            pending[voter_of[i]]++;
+        }
+    }
+
+    priority_queue<int, vector<int>, greater<int>> ready;
+    vector<int> order;
+    vector<int> position(count, -1);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!pending[i])
+            ready.push(i);
+    }
+
+    while (!ready.empty())
+    {
+        int i = ready.top();
+        ready.pop();
+
+        position[i] = order.size();
+        order.push_back(i);
+
+        for (int consumer : consumers[i])
+        {
+            declared[consumer].depth = max(declared[consumer].depth, declared[i].depth + 1);
+
+            if (--pending[consumer] == 0)
+                ready.push(consumer);
+        }
+    }
+
+    if (order.size() != count)
+    {
+        string cycle;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (pending[i])
+                cycle += (cycle.empty() ? "" : ", ") + declared[i].name;
+        }
+
+        fprintf(stderr, "%s: the graph has a cycle through %s\n", path.c_str(), cycle.c_str());
+        delete g;
+        return NULL;
+    }
+
+    // 6) Flatten: the tasks in topological order, their edges and replica groups as index ranges
+    map<string, int> pipe_index;
+
+    for (int i : order)
+    {
+        graph_task t = declared[i];
+
+        if (t.priority < 0)
+            t.priority = t.depth;
+
+        t.first_input = g->m_inputs.size();
+        t.inputs = inputs[i].size();
+
+        for (const string &pipe : inputs[i])
+        {
+            auto it = pipe_index.find(pipe);
+            if (it == pipe_index.end())
+            {
+                it = pipe_index.insert({ pipe, (int)g->m_pipeNames.size() }).first;
+                g->m_pipeNames.push_back(pipe);
+            }
+
+            g->m_inputs.push_back(graph_edge { it->second, position[writer[pipe]], position[i] });
+        }
+
+        t.first_output = g->m_outputs.size();
+        t.outputs = outputs[i].size();
+
+        for (const string &pipe : outputs[i])
+        {
+            auto it = pipe_index.find(pipe);
+            if (it == pipe_index.end())
+            {
+                it = pipe_index.insert({ pipe, (int)g->m_pipeNames.size() }).first;
+                g->m_pipeNames.push_back(pipe);
+            }
+
+            int consumer = (voter_of[i] != -1) ? voter_of[i] : reader[pipe];
+            g->m_outputs.push_back(graph_edge { it->second, position[i], position[consumer] });
+        }
+
+        if (t.voter)
+        {
+            t.group = g->m_groups.size();
+            g->m_groups.push_back(graph_group { position[i], (int)g->m_replicas.size(), (int)replicas[i].size() });
+
+            for (const string &name : replicas[i])
+            {
+                int replica = position[task_index[name]];
+                g->m_replicas.push_back(replica);
+                g->m_tasks[replica].group = t.group;
+            }
+        }
+
+        g->m_tasks.push_back(t);
+    }
+
+    return g;
+}
+
+void graph::build(scheduler *s)
+{
+    for (const string &name : m_pipeNames)
+    {
+#ifdef SIMULATION
+        m_pipes.push_back(new Pipe(-1, -1, name.c_str()));
+#else
+        m_pipes.push_back(Pipe::declare_pipe(name.c_str()));
+#endif
+    }
+
+    vector<task*> tasks;
+
+    for (const graph_task &t : m_tasks)
+    {
+        task *declared;
+
+        if (t.voter)
+        {
+            const graph_group &group = m_groups[t.group];
+            voter *v = voter::declare_voter(t.name, 0, 0, t.priority, t.job, t.type);
+
+            // The replicates come before their voter in topological order
+            for (int r = group.first_replica; r < group.first_replica + group.replicas; r++)
+                v->add_replicate(tasks[m_replicas[r]]);
+
+            v->set_quorum(t.quorum);
+            declared = v;
+        }
+        else
+            declared = task::declare_task(t.name, t.period, t.offset, t.priority, t.job);
+
+        for (int e = t.first_input; e < t.first_input + t.inputs; e++)
+            declared->add_input(m_pipes[m_inputs[e].pipe], t.input_size);
+
+        for (int e = t.first_output; e < t.first_output + t.outputs; e++)
+            declared->add_output(m_pipes[m_outputs[e].pipe]);
+
+        declared->set_cost(t.cost_mean, t.cost_jitter, t.fault_rate);
+
+        s->add_task(declared);
+        tasks.push_back(declared);
+    }
+
+    // The output edges are grouped by producer, so the dependents of a task are its output range
+    vector<int> first_dependent;
+    vector<task*> dependents;
+    vector<task*> voter_of(tasks.size(), NULL);
+
+    for (const graph_task &t : m_tasks)
+        first_dependent.push_back(t.first_output);
+
+    first_dependent.push_back(m_outputs.size());
+
+    for (const graph_edge &e : m_outputs)
+        dependents.push_back(tasks[e.consumer]);
+
+    for (const graph_group &group : m_groups)
+    {
+        for (int r = group.first_replica; r < group.first_replica + group.replicas; r++)
+            voter_of[m_replicas[r]] = tasks[group.voter];
+    }
+
+    s->set_dependents(first_dependent, dependents, voter_of);
+}
+
+void graph::close_pipes()
+{
+    for (Pipe *p : m_pipes)
+    {
+        if (p->get_read_fd() >= 0)
+            close(p->get_read_fd());
+
+        if (p->get_write_fd() >= 0)
+            close(p->get_write_fd());
+
+        delete p;
+    }
+
+    m_pipes.clear();
+}
@@ -0,0 +1,53 @@
+#include <math.h>
+
+#include <histogram.h>
+
+uint64_t latency_histogram::highest_of(int bucket)
+{
+    int shift = (bucket < 2 * LATENCY_HALF_BUCKETS) ? 0 : bucket / LATENCY_HALF_BUCKETS - 1;
+    uint64_t lowest = (uint64_t)(bucket - shift * LATENCY_HALF_BUCKETS) << shift;
+
+    return lowest + ((uint64_t)1 << shift) - 1;
+}
+
+uint64_t latency_histogram::percentile(double percentile) const
+{
+    if (!m_count)
+        return 0;
+
+    // The rank of the value, rounded up so p100 is the last value
+    uint64_t rank = (uint64_t)ceil(percentile / 100.0 * m_count);
+
+    if (rank < 1)
+        rank = 1;
+
+    uint64_t seen = 0;
+
+    for (int i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        seen += m_counts[i];
+
+        if (seen >= rank)
+        {
+            uint64_t value = highest_of(i);
+            return value < m_max ? value : m_max;
+        }
+    }
+
+    return m_max;
+}
+
+void latency_histogram::merge(const latency_histogram &other)
+{
+    for (int i = 0; i < LATENCY_BUCKETS; i++)
+        m_counts[i] += other.m_counts[i];
+
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+
+    if (other.m_count && other.m_min < m_min)
+        m_min = other.m_min;
+
+    if (other.m_max > m_max)
+        m_max = other.m_max;
+}
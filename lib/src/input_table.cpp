@@ -0,0 +1,96 @@
+#include <stdio.h>
+
+#include <input_table.h>
+
+void input_table::add(int fd, int size, Pipe *p, Channel *c)
+{
+    size_t i = m_fds.size();
+
+    m_fds.push_back(fd);
+    m_sizes.push_back(size);
+    m_pipes.push_back(p);
+    m_channels.push_back(c);
+
+    if (i % 64 == 0)
+        m_ready.push_back(0);
+}
+
+void input_table::watch(event_loop *events)
+{
+    m_sources.assign(m_fds.size(), event_source { input_ready, this });
+
+    for (size_t i = 0; i < m_fds.size(); i++)
+    {
+        m_sources[i].index = i;
+
+        if (m_fds[i] >= 0)
+            events->watch_fd(m_fds[i], &m_sources[i], true);
+    }
+}
+
+void input_table::refresh()
+{
+    if (m_stale)
+    {
+        m_stale = false;
+        probe();
+        return;
+    }
+
+    // A channel without a notify fd sends no events
+    for (size_t i = 0; i < m_channels.size(); i++)
+    {
+        if (m_channels[i] != NULL && !get_ready(i) && m_channels[i]->readable())
+            set_ready(i);
+    }
+}
+
+void input_table::probe()
+{
+    m_poll.clear();
+    m_pollInputs.clear();
+
+    for (size_t i = 0; i < m_fds.size(); i++)
+    {
+        if (get_ready(i))
+            continue;
+
+        // Channel readiness is checked in shared memory
+        if (m_channels[i] != NULL)
+        {
+            if (m_channels[i]->readable())
+                set_ready(i);
+
+            continue;
+        }
+
+        if (m_fds[i] < 0)
+        {
+            fprintf(stderr, "Invalid file descriptor: %d\n", m_fds[i]);
+            continue;
+        }
+
+        m_poll.push_back({ m_fds[i], POLLIN, 0 });
+        m_pollInputs.push_back(i);
+    }
+
+    if (m_poll.empty())
+        return;
+
+    int result = poll(m_poll.data(), m_poll.size(), 0);
+
+    if (result < 0)
+    {
+        perror("poll");
+        return;
+    }
+
+    for (size_t e = 0; e < m_poll.size() && result > 0; e++)
+    {
+        if (m_poll[e].revents & POLLIN)
+        {
+            set_ready(m_pollInputs[e]);
+            result--;
+        }
+    }
+}
@@ -0,0 +1,211 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include <sched.h>
+
+#include <log_writer.h>
+
+bool log_writer::start(const string &directory, const vector<task*> &tasks, const vector<core*> &cores)
+{
+    m_numCores = cores.size();
+    m_numTasks = tasks.size();
+
+#ifdef LOG_BINARY
+    vector<string> names;
+    for (task* t : tasks)
+        names.push_back(t->get_name());
+
+    if (!m_trace.open(directory + "/trace.bin", names, m_numCores))
+        return false;
+#else
+    string core_results = directory + "/cores.tsv";
+    string weight_results = directory + "/weights.tsv";
+    string task_results = directory + "/tasks.tsv";
+
+    m_coreFile = fopen(core_results.c_str(), "w");
+    m_weightFile = fopen(weight_results.c_str(), "w");
+    m_taskFile = fopen(task_results.c_str(), "w");
+
+    if (!m_coreFile || !m_weightFile || !m_taskFile)
+    {
+        perror("Failed to open file");
+        return false;
+    }
+
+    // Banners
+    fprintf(m_coreFile, "time");
+    fprintf(m_weightFile, "time");
+    fprintf(m_taskFile, "time");
+
+    for (size_t i = 0; i < m_numCores; i++)
+    {
+        fprintf(m_coreFile, "\tcore_%ld", i);
+        fprintf(m_weightFile, "\tcore_%ld", i);
+    }
+
+    for (task* t : tasks)
+        fprintf(m_taskFile, "\t%s", t->get_name().c_str());
+
+    fprintf(m_coreFile, "\n");
+    fprintf(m_weightFile, "\n");
+    fprintf(m_taskFile, "\n");
+#endif
+
+    // A sample holds a value per core and task, the slots are carved out of one column per field
+    m_coreRuns.assign(LOG_RING_SLOTS * m_numCores, 0);
+    m_weights.assign(LOG_RING_SLOTS * m_numCores, 0);
+    m_taskSuccess.assign(LOG_RING_SLOTS * m_numTasks, 0);
+
+    m_ring = new log_sample[LOG_RING_SLOTS];
+
+    for (size_t i = 0; i < LOG_RING_SLOTS; i++)
+    {
+        m_ring[i].core_runs = m_coreRuns.data() + i * m_numCores;
+        m_ring[i].weights = m_weights.data() + i * m_numCores;
+        m_ring[i].task_success = m_taskSuccess.data() + i * m_numTasks;
+    }
+
+    m_running.store(true, memory_order_release);
+
+    if (pthread_create(&m_thread, NULL, writer_main, this) != 0)
+    {
+        perror("pthread_create");
+        exit(EXIT_FAILURE);
+    }
+
+    // Keep the writer off the scheduler core
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    for (long i = 0; i < cpus && i < CPU_SETSIZE; i++)
+    {
+        if (i != CONFIG.cpu_base + CONFIG.scheduler_core)
+            CPU_SET(i, &cpuset);
+    }
+
+    if (CPU_COUNT(&cpuset) && pthread_setaffinity_np(m_thread, sizeof(cpuset), &cpuset) != 0)
+        perror("pthread_setaffinity_np");
+
+    return true;
+}
+
+void log_writer::push(long time, const vector<task*> &tasks, const vector<core*> &cores)
+{
+    if (m_ring == NULL)
+        return;
+
+    uint64_t head = m_head.load(memory_order_relaxed);
+
+    while (head - m_tail.load(memory_order_acquire) >= LOG_RING_SLOTS)
+    {
+#ifdef SIMULATION
+        sched_yield();
+#else
+        m_dropped++;
+        return;
+#endif
+    }
+
+    log_sample &sample = m_ring[head % LOG_RING_SLOTS];
+    sample.time = time;
+
+    for (size_t i = 0; i < m_numCores; i++)
+    {
+        sample.core_runs[i] = cores[i]->get_runs();
+        sample.weights[i] = cores[i]->get_weight();
+    }
+
+    for (size_t i = 0; i < m_numTasks; i++)
+        sample.task_success[i] = tasks[i]->get_success();
+
+    m_head.store(head + 1, memory_order_release);
+}
+
+void log_writer::stop()
+{
+    if (m_ring == NULL)
+        return;
+
+    m_running.store(false, memory_order_release);
+    pthread_join(m_thread, NULL);
+
+    // The thread drained the ring before it returned
+    FILE *files[] = { m_coreFile, m_weightFile, m_taskFile };
+    for (FILE *f : files)
+    {
+        if (f)
+            fclose(f);
+    }
+
+    m_coreFile = m_weightFile = m_taskFile = NULL;
+
+    delete[] m_ring;
+    m_ring = NULL;
+}
+
+void* log_writer::writer_main(void *arg)
+{
+    log_writer *w = static_cast<log_writer*>(arg);
+
+    while (w->m_running.load(memory_order_acquire))
+    {
+        // Only sleep when the ring is empty
+        if (!w->drain())
+            usleep(LOG_WRITER_PERIOD * 1000);
+    }
+
+    w->drain();
+    return NULL;
+}
+
+size_t log_writer::drain()
+{
+    uint64_t tail = m_tail.load(memory_order_relaxed);
+    uint64_t head = m_head.load(memory_order_acquire);
+
+    if (tail == head)
+        return 0;
+
+    for (uint64_t i = tail; i != head; i++)
+        write_sample(m_ring[i % LOG_RING_SLOTS]);
+
+    m_tail.store(head, memory_order_release);
+
+    // Hand the rows and the open trace block to the kernel, a crash of the scheduler then loses at most one writer period
+    FILE *files[] = { m_coreFile, m_weightFile, m_taskFile };
+    for (FILE *f : files)
+    {
+        if (f)
+            fflush(f);
+    }
+
+    m_trace.flush();
+
+    return head - tail;
+}
+
+void log_writer::write_sample(const log_sample &sample)
+{
+    if (m_trace.is_open())
+    {
+        m_trace.add_sample(sample.time, sample.core_runs, sample.weights, sample.task_success);
+        return;
+    }
+
+    fprintf(m_coreFile, "%ld", sample.time);
+    fprintf(m_weightFile, "%ld", sample.time);
+    fprintf(m_taskFile, "%ld", sample.time);
+
+    for (size_t j = 0; j < m_numCores; j++)
+    {
+        fprintf(m_coreFile, "\t%d", sample.core_runs[j]);
+        fprintf(m_weightFile, "\t%f", sample.weights[j]);
+    }
+
+    for (size_t j = 0; j < m_numTasks; j++)
+        fprintf(m_taskFile, "\t%d", sample.task_success[j]);
+
+    fprintf(m_coreFile, "\n");
+    fprintf(m_weightFile, "\n");
+    fprintf(m_taskFile, "\n");
+}
@@ -13,142 +13,230 @@
 
 #include <scheduler.h>
 #include <flight_controller.h>
+#include <e2e.h>
+#include <config.h>
+#include <writer.h>
+#include <graph.h>
 
-/* Pipes have to be declared in the global scope*/
-#if defined(NMR) || defined(RAVNMR)
+/* Pipes have to be declared in the global scope, the graph of the redundancy mode sets the ones it uses */
+int REPLICAS;
 
-Pipe *AB_1;
-Pipe *AB_2;
-Pipe *AB_3;
-
-Pipe *BV_1;
-Pipe *BV_2;
-Pipe *BV_3;
+Pipe *AB[FC_REPLICAS];
+Pipe *BV[FC_REPLICAS];
 
 Pipe *VC;
 
-#else
-
-Pipe *AB;
-Pipe *BC;
-
-#endif
+uint32_t PATH_B[FC_REPLICAS];
 
+/* Records the sensor to actuator latency, the replicates tag the path their output is on */
+e2e_tracker *E2E;
 
-int main()
+/* A -> B -> C, task B writes to task C directly */
+static void build_baseline(scheduler *s)
 {
-#if defined(NMR)
-    /* Initialize the scheduler */
-    scheduler* s = scheduler::declare_scheduler("NMR");
-    s->init_scheduler();
+    REPLICAS = 1;
 
     /* Declare the pipes */
-    AB_1 = Pipe::declare_pipe("pipe_AB_1");    
-    AB_2 = Pipe::declare_pipe("pipe_AB_2");    
-    AB_3 = Pipe::declare_pipe("pipe_AB_3");    
-    BV_1 = Pipe::declare_pipe("pipe_BV_1");    
-    BV_2 = Pipe::declare_pipe("pipe_BV_2");    
-    BV_3 = Pipe::declare_pipe("pipe_BV_3");    
-    VC = Pipe::declare_pipe("pipe_VC");
+    AB[0] = Pipe::declare_pipe("pipe_AB");
+    BV[0] = Pipe::declare_pipe("pipe_BC");
+    VC = BV[0];
+
+    /* Declare the end-to-end paths */
+    PATH_B[0] = E2E->add_path("A->B->C");
 
     /* Declare the tasks */
-    task* task_A_1 = task::declare_task("task_A_1", 150, 0, 0, read_sensors);
-    task* task_B_1 = task::declare_task("task_B_1", 0, 0, 1, process_data_1);
-    task* task_B_2 = task::declare_task("task_B_2", 0, 0, 1, process_data_2);    
-    task* task_B_3 = task::declare_task("task_B_3", 0, 0, 1, process_data_3);
-    task* task_C_1 = task::declare_task("task_C_1", 0, 0, 2, control_actuators);
+    task* task_A = task::declare_task("task_A", 150, 0, 0, read_sensors);
+    task* task_B = task::declare_task("task_B", 0, 0, 1, process_data_1);
+    task* task_C = task::declare_task("task_C", 0, 0, 2, control_actuators);
 
     /* Setup the task inputs */
-    task_B_1->add_input(AB_1, 4);
-    task_B_2->add_input(AB_2, 4);
-    task_B_3->add_input(AB_3, 4);
-    task_C_1->add_input(VC, 4);
+    task_B->add_input(AB[0], 4);
+    task_C->add_input(VC, 4);
 
-    /* Create the voter and add replicates */
-    voter* v = voter::declare_voter("voter", 0, 0, 3, majority_voter, voter_type::standard);
-    v->add_replicate(task_B_1);
-    v->add_replicate(task_B_2);
-    v->add_replicate(task_B_3);
+    /* Setup the task outputs, used by the simulation */
+    task_A->add_output(AB[0]);
+    task_B->add_output(VC);
+
+#ifdef SIMULATION
+    task_B->set_cost(CONFIG.busy_time, SIM_JITTER, SIM_FAULT_RATE);
+#endif
 
     /* Add tasks to the scheduler */
-    s->add_task(task_A_1);
-    s->add_task(task_B_1);
-    s->add_task(task_B_2);
-    s->add_task(task_B_3);
-    s->add_task(v);   
-    s->add_task(task_C_1);
-#elif defined(RAVNMR)
-    /* Initialize the scheduler */
-    scheduler* s = scheduler::declare_scheduler("RAV-NMR");
-    s->init_scheduler();
+    s->add_task(task_A);
+    s->add_task(task_B);
+    s->add_task(task_C);
+}
+
+/* A -> B_1, B_2, B_3 -> voter -> C, NMR votes with a standard voter and RAV-NMR with a weighted one */
+static void build_nmr(scheduler *s, voter_type type)
+{
+    REPLICAS = FC_REPLICAS;
 
     /* Declare the pipes */
-    AB_1 = Pipe::declare_pipe("pipe_AB_1");    
-    AB_2 = Pipe::declare_pipe("pipe_AB_2");    
-    AB_3 = Pipe::declare_pipe("pipe_AB_3");    
-    BV_1 = Pipe::declare_pipe("pipe_BV_1");    
-    BV_2 = Pipe::declare_pipe("pipe_BV_2");    
-    BV_3 = Pipe::declare_pipe("pipe_BV_3");    
+    AB[0] = Pipe::declare_pipe("pipe_AB_1");
+    AB[1] = Pipe::declare_pipe("pipe_AB_2");
+    AB[2] = Pipe::declare_pipe("pipe_AB_3");
+    BV[0] = Pipe::declare_pipe("pipe_BV_1");
+    BV[1] = Pipe::declare_pipe("pipe_BV_2");
+    BV[2] = Pipe::declare_pipe("pipe_BV_3");
     VC = Pipe::declare_pipe("pipe_VC");
 
+    /* Declare the end-to-end paths */
+    PATH_B[0] = E2E->add_path("A->B_1->voter->C");
+    PATH_B[1] = E2E->add_path("A->B_2->voter->C");
+    PATH_B[2] = E2E->add_path("A->B_3->voter->C");
+
     /* Declare the tasks */
     task* task_A_1 = task::declare_task("task_A_1", 150, 0, 0, read_sensors);
     task* task_B_1 = task::declare_task("task_B_1", 0, 0, 1, process_data_1);
-    task* task_B_2 = task::declare_task("task_B_2", 0, 0, 1, process_data_2);    
+    task* task_B_2 = task::declare_task("task_B_2", 0, 0, 1, process_data_2);
     task* task_B_3 = task::declare_task("task_B_3", 0, 0, 1, process_data_3);
     task* task_C_1 = task::declare_task("task_C_1", 0, 0, 2, control_actuators);
 
     /* Setup the task inputs */
-    task_B_1->add_input(AB_1, 4);
-    task_B_2->add_input(AB_2, 4);
-    task_B_3->add_input(AB_3, 4);
+    task_B_1->add_input(AB[0], 4);
+    task_B_2->add_input(AB[1], 4);
+    task_B_3->add_input(AB[2], 4);
     task_C_1->add_input(VC, 4);
 
+    /* Setup the task outputs, used by the simulation */
+    task_A_1->add_output(AB[0]);
+    task_A_1->add_output(AB[1]);
+    task_A_1->add_output(AB[2]);
+    task_B_1->add_output(BV[0]);
+    task_B_2->add_output(BV[1]);
+    task_B_3->add_output(BV[2]);
+
     /* Create the voter and add replicates */
-    voter* v = voter::declare_voter("voter", 0, 0, 3, majority_voter, voter_type::weighted);
+    voter* v = voter::declare_voter("voter", 0, 0, 3, majority_voter, type);
     v->add_replicate(task_B_1);
     v->add_replicate(task_B_2);
     v->add_replicate(task_B_3);
+    v->add_output(VC);
+#ifdef VOTER_QUORUM
+    v->set_quorum(VOTER_QUORUM);
+#endif
+
+#ifdef SIMULATION
+    /* The replicates vary and may fail, the voter busy waits 10 ms */
+    task_B_1->set_cost(CONFIG.busy_time, SIM_JITTER, SIM_FAULT_RATE);
+    task_B_2->set_cost(CONFIG.busy_time, SIM_JITTER, SIM_FAULT_RATE);
+    task_B_3->set_cost(CONFIG.busy_time, SIM_JITTER, SIM_FAULT_RATE);
+    v->set_cost(10, 0, 0.0);
+#endif
 
     /* Add tasks to the scheduler */
     s->add_task(task_A_1);
     s->add_task(task_B_1);
     s->add_task(task_B_2);
     s->add_task(task_B_3);
-    s->add_task(v);   
+    s->add_task(v);
     s->add_task(task_C_1);
-#else
-    /* Initialize the scheduler */
-    scheduler* s = scheduler::declare_scheduler("baseline");
-    s->init_scheduler();
+}
 
-    /* Declare the pipes */
-    AB = Pipe::declare_pipe("pipe_AB");
-    BC = Pipe::declare_pipe("pipe_BC");
+/* Closes the pipes of the last graph, the next mode declares its own */
+static void close_pipes()
+{
+    Pipe *pipes[] = { AB[0], AB[1], AB[2], BV[0], BV[1], BV[2], VC };
 
-    /* Declare the tasks */
-    task* task_A = task::declare_task("task_A", 150, 0, 0, read_sensors);
-    task* task_B = task::declare_task("task_B", 0, 0, 1, process_data);
-    task* task_C = task::declare_task("task_C", 0, 0, 2, control_actuators);
+    for (size_t i = 0; i < sizeof(pipes) / sizeof(pipes[0]); i++)
+    {
+        Pipe *p = pipes[i];
 
-    /* Setup the task inputs */
-    task_B->add_input(AB, 4);
-    task_C->add_input(BC, 4);
+        // The baseline declares BV[0] and VC as the same pipe
+        if (p == NULL || (i == 6 && p == BV[0]))
+            continue;
 
-    /* Add tasks to the scheduler */
-    s->add_task(task_A);
-    s->add_task(task_B);
-    s->add_task(task_C);
-#endif
+        close(p->get_read_fd());
+        close(p->get_write_fd());
+        delete p;
+    }
 
-    /* Start the scheduler loop */
-    s->start_scheduler();
+    for (int r = 0; r < FC_REPLICAS; r++)
+        AB[r] = BV[r] = NULL;
 
-    /* Optional: write the result in .tsv format */
-    s->write_results_to_tsv();    
+    VC = NULL;
+}
 
-    /* Free any allocated memory */
-    s->cleanup_scheduler();
+int main(int argc, char *argv[])
+{
+    /* Override the defaults of defines.h, e.g. --cores 8 --busy-time 20 --mode nmr */
+    if (!config_parse(CONFIG, argc, argv))
+    {
+        fprintf(stderr, "Usage: %s [--key value ...]\n", argv[0]);
+        config_usage(stderr, CONFIG);
+        return EXIT_FAILURE;
+    }
+
+    /* A graph file replaces the graphs of the redundancy modes */
+    if (!CONFIG.graph.empty())
+    {
+        graph *g = graph::load_graph(CONFIG.graph);
+
+        if (g == NULL)
+            return EXIT_FAILURE;
+
+        scheduler* s = scheduler::declare_scheduler(g->get_name());
+        s->init_scheduler();
+
+        /* A sample holds a value per task, large graphs only sample their first tasks */
+        if (g->get_tasks().size() > MAX_LOGGED_TASKS)
+        {
+            fprintf(stderr, "Graph %s has %zu tasks, only the first %d are sampled\n", g->get_name().c_str(), g->get_tasks().size(), MAX_LOGGED_TASKS);
+            s->set_logged_tasks(MAX_LOGGED_TASKS);
+        }
+
+        g->build(s);
+
+        s->start_scheduler();
+        s->write_results_to_tsv();
+        s->cleanup_scheduler();
+
+        g->close_pipes();
+        delete g;
+        delete s;
+
+        return 0;
+    }
+
+    /* Every mode of a back to back run writes to its own directory in the given result directory */
+    string results = CONFIG.results;
+
+    if (!results.empty() && CONFIG.modes.size() > 1 && create_directory(results))
+        return EXIT_FAILURE;
+
+    for (redundancy_mode mode : CONFIG.modes)
+    {
+        if (!results.empty() && CONFIG.modes.size() > 1)
+            CONFIG.results = results + "/" + mode_name(mode);
+
+        /* Initialize the scheduler */
+        scheduler* s = scheduler::declare_scheduler(mode_name(mode));
+        s->init_scheduler();
+
+        /* Every run tracks its own end-to-end paths */
+        E2E = e2e_tracker::declare_e2e_tracker();
+        s->set_e2e_tracker(E2E);
+
+        if (mode == redundancy_mode::baseline)
+            build_baseline(s);
+        else
+            build_nmr(s, (mode == redundancy_mode::nmr) ? voter_type::standard : voter_type::weighted);
+
+        /* Start the scheduler loop */
+        s->start_scheduler();
+
+        /* Optional: write the result in .tsv format */
+        s->write_results_to_tsv();
+
+        /* Free any allocated memory, the next mode starts from a clean process */
+        s->cleanup_scheduler();
+        close_pipes();
+
+        delete s;
+        delete E2E;
+        E2E = NULL;
+    }
 
     return 0;
 }
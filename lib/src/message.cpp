@@ -0,0 +1,24 @@
+#include <time.h>
+
+#include <message.h>
+
+uint32_t message_checksum(const void *data, size_t size)
+{
+    const uint8_t *bytes = static_cast<const uint8_t*>(data);
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+uint64_t message_clock()
+{
+    struct timespec spec;
+    clock_gettime(CLOCK_MONOTONIC, &spec);
+    return ((uint64_t)spec.tv_sec * 1000000000) + spec.tv_nsec;
+}
@@ -0,0 +1,66 @@
+#include <algorithm>
+
+#include <metrics.h>
+
+void metrics_store::init(size_t cores, size_t tasks, size_t capacity)
+{
+    size_t sampleBytes = sizeof(long) + cores * (sizeof(int) + sizeof(float)) + tasks * sizeof(int);
+
+    m_capacity = min(capacity, max((size_t)1, (size_t)MAX_LOG_BYTES / sampleBytes));
+    m_rows = 0;
+    m_numCores = cores;
+    m_numTasks = tasks;
+    m_next = 0;
+    m_count = 0;
+    m_dropped = 0;
+
+    m_time.clear();
+    m_coreRuns.clear();
+    m_weights.clear();
+    m_taskSuccess.clear();
+}
+
+void metrics_store::grow()
+{
+    m_rows = min(m_capacity, max((size_t)64, m_rows * 2));
+
+    m_time.resize(m_rows);
+    m_coreRuns.resize(m_rows * m_numCores);
+    m_weights.resize(m_rows * m_numCores);
+    m_taskSuccess.resize(m_rows * m_numTasks);
+}
+
+void metrics_store::record(long time, const vector<task*> &tasks, const vector<core*> &cores)
+{
+    if (!m_capacity)
+        return;
+
+    // The store only wraps once all m_capacity rows are allocated
+    if (m_next == m_rows)
+        grow();
+
+    size_t row = m_next;
+
+    m_time[row] = time;
+
+    int *runs = &m_coreRuns[row * m_numCores];
+    float *weights = &m_weights[row * m_numCores];
+
+    for (size_t i = 0; i < m_numCores; i++)
+    {
+        runs[i] = cores[i]->get_runs();
+        weights[i] = cores[i]->get_weight();
+    }
+
+    int *success = &m_taskSuccess[row * m_numTasks];
+
+    for (size_t i = 0; i < m_numTasks; i++)
+        success[i] = tasks[i]->get_success();
+
+    m_next = (m_next + 1) % m_capacity;
+
+    if (m_count < m_capacity)
+        m_count++;
+    else
+        m_dropped++;
+}
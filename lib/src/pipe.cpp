@@ -1,4 +1,4 @@
-#include <sys/select.h>
+#include <poll.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -11,6 +11,14 @@
 
 using namespace std;
 
+// Checks a single descriptor without waiting, poll() has no FD_SETSIZE limit on the descriptor number
+static bool readable(int fd)
+{
+    struct pollfd entry = { fd, POLLIN, 0 };
+
+    return poll(&entry, 1, 0) > 0 && (entry.revents & POLLIN);
+}
+
 Pipe::Pipe()
 {
 
@@ -68,30 +76,27 @@ Pipe* Pipe::declare_pipe(const char* name)
 bool Pipe::read_data(char *buffer, size_t buf_size)
 {
     //close(pipe->get_write_fd());
+#ifndef WORKER_POOL
+    // Only the copies of this child are closed, a persistent worker has to keep them open
     close(m_write_fd);
+#endif
 
-    fd_set read_fds;
-    FD_ZERO(&read_fds);
-    FD_SET(get_read_fd(), &read_fds);
-
-    struct timeval timeout;
-    timeout.tv_sec = 0;
-    timeout.tv_usec = 0;
-    
-    int ready = select(m_read_fd + 1, &read_fds, NULL, NULL, &timeout);    
-
-    if (ready > 0) 
+    if (readable(m_read_fd)) 
     {
         ssize_t num_bytes = read(m_read_fd, buffer, buf_size - 1);
         if (num_bytes > 0)
         {
             buffer[num_bytes] = '\0';
+#ifndef WORKER_POOL
             close(m_read_fd);
+#endif
             return true;
         }
     }
     
+#ifndef WORKER_POOL
     close(m_read_fd);
+#endif
     return false;
 }
 
@@ -126,11 +131,71 @@ bool Pipe::read_data(char *buffer, size_t buf_size)
 
 void Pipe::write_data(const char *buffer) 
 {    
+#ifndef WORKER_POOL
     close(m_read_fd);
+#endif
 
     write(m_write_fd, buffer, strlen(buffer) + 1);
 
+#ifndef WORKER_POOL
+    close(m_write_fd);
+#endif
+}
+
+bool Pipe::read_raw(void *buffer, size_t size)
+{
+#ifndef WORKER_POOL
+    close(m_write_fd);
+#endif
+
+    bool complete = false;
+
+    if (readable(m_read_fd))
+        complete = read(m_read_fd, buffer, size) == (ssize_t)size;
+
+#ifndef WORKER_POOL
+    close(m_read_fd);
+#endif
+    return complete;
+}
+
+bool Pipe::read_latest_raw(void *buffer, size_t size)
+{
+#ifndef WORKER_POOL
+    close(m_write_fd);
+#endif
+
+    bool complete = false;
+
+    while (true)
+    {
+        if (!readable(m_read_fd))
+            break;
+
+        if (read(m_read_fd, buffer, size) != (ssize_t)size)
+            break;
+
+        complete = true;
+    }
+
+#ifndef WORKER_POOL
+    close(m_read_fd);
+#endif
+    return complete;
+}
+
+bool Pipe::write_raw(const void *buffer, size_t size)
+{
+#ifndef WORKER_POOL
+    close(m_read_fd);
+#endif
+
+    bool complete = write(m_write_fd, buffer, size) == (ssize_t)size;
+
+#ifndef WORKER_POOL
     close(m_write_fd);
+#endif
+    return complete;
 }
 
 //void write_to_pipe(Pipe *pipe, const char *buffer);
@@ -11,9 +11,12 @@
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <sys/prctl.h>
+#include <sys/eventfd.h>
+#include <signal.h>
 #include <string.h>
 #include <algorithm>
 #include <queue>
+#include <unordered_map>
 
 #include <writer.h>
 #include <scheduler.h>
@@ -27,41 +30,466 @@ scheduler* scheduler::declare_scheduler(string name)
     return s;
 }
 
-void scheduler::init_scheduler()
+void scheduler::init_cores(int cores)
 {
-    // init the cores
-    for (int i = 0; i < NUM_OF_CORES; i++)
+    for (int i = 0; i < cores; i++)
     {
         core *c = new core(i, MAX_CORE_WEIGHT, false, 0);
         m_cores.push_back(c);
-    }   
+
+        // The scheduler core never runs tasks
+        if (i != CONFIG.scheduler_core)
+            m_coreIndex.add_core(c);
+    }
+}
+
+void scheduler::init_scheduler()
+{
+    init_cores(CONFIG.cores);
     
     // Set current time
     m_activationTime = time(NULL);
     m_log_timeout = time(NULL);
 
+#ifdef SIMULATION
+    // The virtual clock starts at the real time, so the output matches a real run. Nothing is pinned.
+    struct timespec spec;
+    clock_gettime(CLOCK_REALTIME, &spec);
+    m_virtualTime = (spec.tv_sec * 1000) + (spec.tv_nsec / 1000000);
+    return;
+#endif
+
     // Specify the CPU core to run the scheduler on
     cpu_set_t cpuset;
     CPU_ZERO(&cpuset);    
-    CPU_SET(SCHEDULER_CORE, &cpuset);
+    CPU_SET(CONFIG.cpu_base + CONFIG.scheduler_core, &cpuset);
 
     if (sched_setaffinity(0, sizeof(cpuset), &cpuset) != 0) 
     {
         perror("sched_setaffinity");
         exit(EXIT_FAILURE);
     }
+
+#ifdef EVENT_DRIVEN
+    m_events = event_loop::declare_event_loop();
+    m_readiness = m_events;
+#else
+    m_readiness = event_loop::declare_readiness_set();
+#endif
 }
 
 void scheduler::start_scheduler()
 {
+    prepare_run();
+
     while(active())
+        run_pass();
+
+    printResults();
+}
+
+void scheduler::prepare_run()
+{
+    init_deadlines();
+    init_task_sets();
+
+#ifdef EVENT_TRACE
+    m_timeline.init(EVENT_TRACE_SLOTS, current_time_in_ns());
+#endif
+
+#if defined(LOGGING) && defined(ASYNC_LOGGING)
+    if (m_logging && create_result_directory())
+        m_logWriter.start(m_resultDirectory, vector<task*>(m_tasks.begin(), m_tasks.begin() + get_logged_tasks()), m_cores);
+#elif defined(LOGGING)
+    if (m_logging)
+        m_metrics.init(m_cores.size(), get_logged_tasks(), MAX_LOG_SAMPLES);
+#endif
+
+#ifndef SIMULATION
+    watch_inputs();
+#endif
+
+#ifdef WORKER_POOL
+    spawn_workers();
+#endif
+}
+
+void scheduler::run_pass()
+{
+    // The cost of a tick is measured on the real clock, also if SIMULATION is defined
+    uint64_t start = monotonic_ns();
+
+    monitor_tasks();
+    run_tasks();
+
+    m_tickCost.record(monotonic_ns() - start);
+
+    log_results();
+
+#ifdef EVENT_DRIVEN
+    wait_for_events();
+#endif
+
+#ifdef SIMULATION
+    advance_clock();
+#endif
+}
+
+void scheduler::spawn_workers()
+{
+    // A worker that died while idle is detected by a failing write on its control pipe
+    signal(SIGPIPE, SIG_IGN);
+
+    for (int i = 0; i < CONFIG.cores; i++)
     {
-        monitor_tasks();
-        run_tasks();
-        log_results();
+        if (i == CONFIG.scheduler_core)
+        {
+            m_workers.push_back(NULL);
+            continue;
+        }
+
+        worker *w = worker::declare_worker(i);
+        w->spawn(m_tasks, m_events);
+        m_workers.push_back(w);
     }
+}
 
-    printResults();
+pid_t scheduler::poll_job(task *t, int *status)
+{
+#if defined(SIMULATION)
+    if (!t->get_sim_done())
+        return 0;
+
+    // There is no process, any other value than 0 and -1 reports a completed job
+    *status = t->get_sim_status();
+    return 1;
+#elif defined(WORKER_POOL)
+    worker *w = m_workers[t->get_cpu_id()];
+    job_usage usage;
+    pid_t result = w->poll(status, &usage);
+
+    // A worker that died did not report the usage of the job
+    if (result > 0 && w->get_alive())
+        t->set_job_usage(usage);
+
+    return result;
+#else
+    // Reaping with wait4() returns the resource usage of the job without an extra syscall
+    struct rusage usage;
+    pid_t result = wait4(t->get_pid(), status, WNOHANG, &usage);
+
+    if (result > 0)
+        t->set_job_usage(usage_from_rusage(usage, NULL));
+
+    return result;
+#endif
+}
+
+void scheduler::wait_for_events()
+{
+    // Something changed, run another pass before going to sleep; the input events are collected anyway
+    if (m_progress)
+    {
+        m_progress = false;
+        collect_input_events();
+        return;
+    }
+
+    m_events->arm_timer(next_deadline(current_time_in_ms()));
+    m_events->wait(true);
+    wake_filled_inputs();
+}
+
+void scheduler::advance_clock()
+{
+    // Something changed, run another pass at the same time
+    if (m_progress)
+    {
+        m_progress = false;
+        return;
+    }
+
+    long next = next_deadline(m_virtualTime);
+
+    // Nothing is pending, let time pass anyway
+    m_virtualTime = (next > m_virtualTime) ? next : m_virtualTime + 1;
+}
+
+void scheduler::simulate_job(task *t)
+{
+    const task_cost &cost = t->get_cost();
+
+    uniform_int_distribution<int> jitter(-cost.jitter, cost.jitter);
+    bernoulli_distribution fault(cost.fault_rate);
+
+    long duration = cost.mean + jitter(m_rng);
+    if (duration < 1)
+        duration = 1;
+
+    t->take_input_tokens();
+    t->set_sim_status(fault(m_rng) ? W_EXITCODE(1, 0) : W_EXITCODE(0, 0));
+    t->set_sim_done(false);
+
+    m_deadlines.push(t->get_startTime() + duration, t, deadline_completion, t->get_runs());
+}
+
+void scheduler::collect_input_events()
+{
+    if (!m_readiness)
+        return;
+
+    // A full batch may leave events behind
+    while (m_readiness->wait(false) == MAX_EPOLL_EVENTS) { }
+
+    wake_filled_inputs();
+}
+
+void scheduler::wake_filled_inputs()
+{
+    vector<int> &filled = m_readiness->get_filled_inputs();
+
+    for (int id : filled)
+    {
+        if (id >= 0 && id < (int)m_tasks.size())
+            wake_task(m_tasks[id]);
+    }
+
+    filled.clear();
+}
+
+void scheduler::init_task_sets()
+{
+    size_t n = m_tasks.size();
+
+    m_rank.assign(n, 0);
+    for (size_t i = 0; i < m_monitorOrder.size(); i++)
+        m_rank[m_monitorOrder[i]->get_id()] = i;
+
+    m_running.clear();
+    m_running.reserve(n);
+    m_runningSlot.assign(n, -1);
+    m_woken.clear();
+    m_woken.reserve(n);
+    m_isWoken.assign(n, false);
+    m_starved.clear();
+    m_starved.reserve(n);
+    m_passTasks.reserve(n);
+
+    // A graph sets the dependents when it is built
+    if (m_firstDependent.size() != n + 1 || m_voterOf.size() != n)
+        derive_dependents();
+
+    // The first pass checks every task
+    for (task* t : m_tasks)
+        wake_task(t);
+}
+
+void scheduler::derive_dependents()
+{
+    size_t n = m_tasks.size();
+
+    // The consumer of every pipe and channel, a producer wakes them when its run ends
+    unordered_map<const void*, task*> consumers;
+
+    for (task* t : m_tasks)
+    {
+        input_table &inputs = t->get_inputs();
+
+        for (size_t i = 0; i < inputs.size(); i++)
+            consumers[inputs.get_pipe(i) ? (const void*)inputs.get_pipe(i) : (const void*)inputs.get_channel(i)] = t;
+    }
+
+    m_firstDependent.assign(n + 1, 0);
+    m_dependents.clear();
+    m_voterOf.assign(n, NULL);
+
+    for (task* t : m_tasks)
+    {
+        m_firstDependent[t->get_id()] = m_dependents.size();
+
+        for (output *o = t->get_outputs(); o != NULL; o = o->next)
+        {
+            const void *key = o->pipe ? (const void*)o->pipe : (const void*)o->channel;
+            auto it = consumers.find(key);
+
+            if (it != consumers.end())
+            {
+                m_dependents.push_back(it->second);
+                consumers.erase(it);
+            }
+        }
+
+        if (t->get_voter())
+        {
+            for (task* r : static_cast<voter*>(t)->get_replicates())
+                m_voterOf[r->get_id()] = t;
+        }
+    }
+
+    m_firstDependent[n] = m_dependents.size();
+
+    // A pipe or a channel with a notify fd sends an event when it is written. A channel without one
+    // only wakes its consumer through the output of its producer, so a consumer of an undeclared output is polled
+    m_polled.clear();
+
+    for (task* t : m_tasks)
+    {
+        input_table &inputs = t->get_inputs();
+
+        for (size_t i = 0; i < inputs.size(); i++)
+        {
+            Channel *c = inputs.get_channel(i);
+
+            if (c != NULL && c->get_notify_fd() < 0 && consumers.count(c))
+            {
+                fprintf(stderr, "No task declares channel %s as an output, %s is checked every pass\n", c->get_name(), t->get_name().c_str());
+                m_polled.push_back(t);
+                break;
+            }
+        }
+    }
+}
+
+void scheduler::set_dependents(const vector<int>& firstDependent, const vector<task*>& dependents, const vector<task*>& voterOf)
+{
+    m_firstDependent = firstDependent;
+    m_dependents = dependents;
+    m_voterOf = voterOf;
+}
+
+void scheduler::wake_task(task *t)
+{
+    int id = t->get_id();
+
+    if (m_isWoken[id])
+        return;
+
+    m_isWoken[id] = true;
+    m_woken.push_back(t);
+}
+
+void scheduler::add_running(task *t)
+{
+    m_runningSlot[t->get_id()] = m_running.size();
+    m_running.push_back(t);
+
+    // The voter arms on the dispatch of its replicates
+    if (m_voterOf[t->get_id()])
+        wake_task(m_voterOf[t->get_id()]);
+}
+
+void scheduler::remove_running(task *t)
+{
+    int slot = m_runningSlot[t->get_id()];
+
+    if (slot != -1)
+    {
+        m_running[slot] = m_running.back();
+        m_runningSlot[m_running[slot]->get_id()] = slot;
+        m_running.pop_back();
+        m_runningSlot[t->get_id()] = -1;
+    }
+
+    wake_task(t);
+
+    for (int d = m_firstDependent[t->get_id()]; d < m_firstDependent[t->get_id() + 1]; d++)
+        wake_task(m_dependents[d]);
+
+    if (m_voterOf[t->get_id()])
+        wake_task(m_voterOf[t->get_id()]);
+
+    // A core was released
+    for (task* starved : m_starved)
+        wake_task(starved);
+
+    m_starved.clear();
+}
+
+void scheduler::watch_inputs()
+{
+    for (task* t : m_tasks)
+        t->get_inputs().watch(m_readiness);
+}
+
+void scheduler::init_deadlines()
+{
+    // A release and an offset per task, plus the stuck timeouts (and simulated completions) of the running jobs
+    m_deadlines.reserve(m_tasks.size() * 4);
+
+    // The offsets count from the start of the run, in the milliseconds of the heap (the virtual clock if SIMULATION is defined)
+    unsigned long start = current_time_in_ms();
+
+    for (task* t : m_tasks)
+    {
+        if (t->get_offset())
+        {
+            t->set_offset_elapsed(false);
+            m_deadlines.push(start + t->get_offset() + 1, t, deadline_offset, 0);
+        }
+
+        if (t->get_period())
+        {
+            t->set_released(false);
+            m_deadlines.push(t->get_startTime() + t->get_period() + 1, t, deadline_release, t->get_runs());
+        }
+    }
+}
+
+void scheduler::expire_deadlines(unsigned long int currentTime)
+{
+    deadline_entry entry;
+    uint64_t now = 0;
+
+    while (m_deadlines.pop_expired(currentTime, entry))
+    {
+        switch (entry.type)
+        {
+            case deadline_release:
+                entry.t->set_released(true);
+                wake_task(entry.t);
+                now = now ? now : current_time_in_ns();
+                entry.t->mark_released(now);
+                trace_event(now, timeline_release, entry.t, 0);
+                break;
+            case deadline_offset:
+                entry.t->set_offset_elapsed(true);
+                wake_task(entry.t);
+                now = now ? now : current_time_in_ns();
+                entry.t->mark_released(now);
+                trace_event(now, timeline_release, entry.t, 0);
+                break;
+            case deadline_stuck:
+                // Ignore the timeouts of runs that already completed
+                if (entry.t->get_state() == task_state::running && entry.t->get_runs() == entry.generation)
+                    entry.t->set_stuck_check(true);
+                break;
+            case deadline_completion:
+                if (entry.t->get_state() == task_state::running && entry.t->get_runs() == entry.generation)
+                    entry.t->set_sim_done(true);
+                break;
+        }
+    }
+}
+
+long scheduler::next_deadline(long currentTime)
+{
+    long next = m_deadlines.next_deadline();
+
+#ifdef LOGGING
+    long log_deadline = m_log_timeout + MAX_LOG_INTERVAL + 1;
+
+    if (log_deadline > currentTime && (!next || log_deadline < next))
+        next = log_deadline;
+#endif
+
+#ifdef TIME_BASED
+    long end = (m_activationTime * 1000) + CONFIG.run_time;
+
+    if (end > currentTime && (!next || end < next))
+        next = end;
+#endif
+
+    return next;
 }
 
 void scheduler::monitor_tasks()
@@ -71,28 +499,49 @@ void scheduler::monitor_tasks()
     
     unsigned long current_time = current_time_in_ms();
 
-    priority_queue<task*, vector<task*>, CompareTask> task_queue;
-    for (task* t : m_tasks) { task_queue.push(t); }
+    expire_deadlines(current_time);
 
-    //for (auto& task : m_tasks) 
+#ifndef EVENT_DRIVEN
+    // Without the event loop the input events are collected once per pass
+    collect_input_events();
+#endif
 
-    while (!task_queue.empty())
-    {   
-        task* task = task_queue.top();
-        task_queue.pop();
+    for (task* t : m_polled)
+        wake_task(t);
+
+    // Only the running tasks and the tasks something happened to are visited, in monitor order
+    m_passTasks.assign(m_running.begin(), m_running.end());
+
+    for (task* t : m_woken)
+    {
+        m_isWoken[t->get_id()] = false;
+
+        if (t->get_state() != task_state::running)
+            m_passTasks.push_back(t);
+    }
+
+    m_woken.clear();
+    sort(m_passTasks.begin(), m_passTasks.end(), [this](task* lhs, task* rhs) { return m_rank[lhs->get_id()] < m_rank[rhs->get_id()]; });
 
-        if (!task->offset_elapsed(m_activationTime, current_time))
+    for (task* task : m_passTasks)
+    {   
+        if (!task->get_offset_elapsed())
             continue;
         
         if (task->get_state() == task_state::running) 
         {            
-            result = waitpid(task->get_pid(), &status, WNOHANG);
+            result = poll_job(task, &status);
 
             if (result == 0) 
             {                
-                if (task->is_stuck(current_time, status, result)) 
+                if (task->get_stuck_check() && task->is_stuck(current_time, status, result)) 
                 {
+#ifdef WORKER_POOL
+                    // A hanging worker is replaced, its job counts as a crash
+                    m_workers[task->get_cpu_id()]->kill_worker(m_events);
+#endif
                     task->set_state(task_state::crashed);
+                    trace_event(timeline_stuck, task, 0);
                     handle_task_completion(task, 1, result);
 
                     continue;
@@ -108,16 +557,34 @@ void scheduler::monitor_tasks()
 
         }
 
-        if (task->task_input_full(task) && task->get_state() != task_state::running && task->period_elapsed(current_time))
+        if (task->task_input_full(task) && task->get_state() != task_state::running && task->get_released())
         {            
             task->set_state(task_state::fireable);
+            task->mark_ready(current_time_in_ns());
             int core_id;
 
             if (task->get_voter())
             {
                 voter* v = static_cast<voter*>(task);
+                bool weighted = v->get_voter_type() == voter_type::weighted;
+
+                core_id = find_core(weighted);
+
+#ifdef CANCEL_LAGGARDS
+                // The vote only runs with a core, the one found or one the laggards free. Then the laggards are cancelled
+                if (core_id != -1 || laggards_free_core(v, weighted))
+                {
+                    for (auto& laggard : v->get_last_laggards())
+                        cancel_task(laggard);
+
+                    if (core_id == -1)
+                        core_id = find_core(weighted);
+                }
+#endif
 
-                v->get_voter_type() == voter_type::weighted ? core_id = find_core(true) : core_id = find_core(false);
+                // The vote is decided, it is retried when a core frees up instead of being lost
+                if (core_id == -1)
+                    v->defer_vote();
             }
             else
             {
@@ -127,10 +594,15 @@ void scheduler::monitor_tasks()
             if (core_id != -1)
             {
                 task->set_cpu_id(core_id);
+                m_readyQueue.push(task);
+
+                if (task->get_voter())
+                    trace_event(timeline_vote, task, static_cast<voter*>(task)->get_last_laggards().size());
             }
             else
             {
                 task->set_state(task_state::idle);
+                m_starved.push_back(task);
             }
         }
     }
@@ -147,7 +619,11 @@ void scheduler::handle_task_completion(task *t, int status, pid_t result)
         if (WEXITSTATUS(status) == 0) 
         {
             t->set_success(t->get_success() + 1);
-            core->update_weight(MAX_CORE_WEIGHT / CORE_BUFFER_SIZE);
+            core->update_weight(MAX_CORE_WEIGHT / CONFIG.buffer_size);
+
+#ifdef SIMULATION
+            t->add_output_tokens();
+#endif
 
             if (core->get_weight() > MAX_CORE_WEIGHT)
                 core->set_weight(MAX_CORE_WEIGHT);
@@ -173,37 +649,204 @@ void scheduler::handle_task_completion(task *t, int status, pid_t result)
     core->increase_runs();
     core->set_active(false);
 
+    // The job consumed its inputs, events of data it read are dropped and the next check probes what is left
+    collect_input_events();
+    t->get_inputs().clear_ready();
+
+    uint64_t completed = current_time_in_ns();
+
+    if (result != -1)
+        t->mark_completed(completed);
+
+    trace_event(completed, t->get_state() == task_state::crashed ? timeline_crash : timeline_completion, t, status);
+
+    job_usage usage;
+
+    if (t->take_job_usage(usage))
+    {
+        t->add_job_usage(usage);
+        core->add_job_usage(usage);
+    }
+
+#ifdef PERF_COUNTERS
+    counter_totals job;
+
+    if (t->get_perf().read(job))
+    {
+        t->add_job_counters(job);
+        core->add_job_counters(job);
+    }
+#endif
+
+#ifdef SIMULATION
+    t->addRuntime(current_time_in_ms() - t->get_startTime());
+#else
     t->incrementRuntime();
+#endif
+    t->set_stuck_check(false);
+
+#ifdef WORKER_POOL
+    worker *w = m_workers[t->get_cpu_id()];
+    w->set_job(NULL);
+
+    if (!w->get_alive())
+    {
+        w->kill_worker(m_events);
+        w->spawn(m_tasks, m_events);
+    }
+#endif
+
+#ifdef EVENT_DRIVEN
+    m_events->unwatch_fd(t->get_pidfd());
+    t->set_pidfd(-1);
+#endif
+
+    remove_running(t);
+    m_progress = true;
 }
 
-void scheduler::run_tasks()
+void scheduler::cancel_task(task *t)
 {
-    priority_queue<task*, vector<task*>, CompareTask> task_queue;
-    for (task* t : m_tasks) { task_queue.push(t); }
+    int status;
+
+    if (t->get_state() != task_state::running)
+        return;
+
+    // The job may have finished since the last poll
+    pid_t result = poll_job(t, &status);
+
+    if (result != 0)
+    {
+        t->set_latest(status, result);
+        handle_task_completion(t, status, result);
+        return;
+    }
+
+#if defined(SIMULATION)
+    // The completion deadline of the run is discarded when it expires
+#elif defined(WORKER_POOL)
+    worker *w = m_workers[t->get_cpu_id()];
+    w->kill_worker(m_events);
+    w->spawn(m_tasks, m_events);
+#else
+    kill(t->get_pid(), SIGKILL);
+    waitpid(t->get_pid(), NULL, 0);
+#endif
+
+    auto &core = m_cores[t->get_cpu_id()];
+    core->increase_runs();
+    core->set_active(false);
+
+    t->increment_cancelled();
+    collect_input_events();
+    t->get_inputs().clear_ready();
+    trace_event(timeline_cancel, t, 0);
+    t->set_stuck_check(false);
+    t->get_perf().close();
+    t->set_state(task_state::idle);
+
+#ifdef EVENT_DRIVEN
+    m_events->unwatch_fd(t->get_pidfd());
+    t->set_pidfd(-1);
+#endif
 
+    remove_running(t);
+    m_progress = true;
+}
+
+void scheduler::run_tasks()
+{
     // Fork and set CPU affinity for each task
-    while (!task_queue.empty())
+    while (!m_readyQueue.empty())
     {   
-        task* task = task_queue.top();
-        task_queue.pop();
+        task* task = m_readyQueue.top();
+        m_readyQueue.pop();
     
         if (task->get_state() == task_state::fireable) 
         {
             task->set_startTime(current_time_in_ms());     
             task->increment_runs();
 
-            auto customStartTime = std::chrono::high_resolution_clock::now();
-            task->setStartTime(customStartTime);        
+            // Arm the stuck timeout of this run and the next release of periodic tasks
+            m_deadlines.push(task->get_startTime() + CONFIG.stuck_time + 1, task, deadline_stuck, task->get_runs());
+
+            if (task->get_period())
+            {
+                task->set_released(false);
+                m_deadlines.push(task->get_startTime() + task->get_period() + 1, task, deadline_release, task->get_runs());
+            }
+
+            auto customStartTime = std::chrono::high_resolution_clock::now();
+            task->setStartTime(customStartTime);        
+
+#if defined(SIMULATION)
+            simulate_job(task);
+
+            task->set_pid(0);
+            task->set_state(task_state::running);
+            add_running(task);
+            task->add_core_run(task->get_cpu_id());
+            uint64_t dispatched = current_time_in_ns();
+            task->mark_dispatched(dispatched);
+            trace_event(dispatched, timeline_dispatch, task, 0);
+
+            m_progress = true;
+#elif defined(WORKER_POOL)
+            worker *w = m_workers[task->get_cpu_id()];
+#ifdef PERF_COUNTERS
+            // Count the worker from before it receives the job
+            task->get_perf().open(w->get_pid());
+#endif
+            pid_t pid = w->dispatch(task);
+
+            if (pid == -1)
+            {
+                // The worker died while idle, replace it and try once more
+                w->kill_worker(m_events);
+                w->spawn(m_tasks, m_events);
+#ifdef PERF_COUNTERS
+                task->get_perf().open(w->get_pid());
+#endif
+                pid = w->dispatch(task);
+            }
+
+            if (pid == -1)
+                exit(EXIT_FAILURE);
+            else
+            {
+                task->set_pid(pid);
+                task->set_state(task_state::running);
+                add_running(task);
+                task->add_core_run(task->get_cpu_id());
+                uint64_t dispatched = current_time_in_ns();
+                task->mark_dispatched(dispatched);
+                trace_event(dispatched, timeline_dispatch, task, 0);
+
+                m_progress = true;
+            }
+#else
+#ifdef PERF_COUNTERS
+            // The child waits on it until its counters are open, so the whole job is counted
+            int counting = eventfd(0, EFD_CLOEXEC);
 
+            if (counting == -1)
+            {
+                perror("eventfd");
+                exit(EXIT_FAILURE);
+            }
+#endif
             pid_t pid = fork();
 
             if (pid == -1)
                 exit(EXIT_FAILURE);
             else if (pid == 0) 
             {
+#ifdef EVENT_DRIVEN
+                m_events->reset_child_signals();
+#endif
                 cpu_set_t cpuset;
                 CPU_ZERO(&cpuset);
-                CPU_SET(task->get_cpu_id(), &cpuset);
+                CPU_SET(CONFIG.cpu_base + task->get_cpu_id(), &cpuset);
 
                 if (prctl(PR_SET_NAME, (unsigned long) task->get_name().c_str()) < 0)
                     perror("prctl()");
@@ -214,42 +857,90 @@ void scheduler::run_tasks()
                     exit(EXIT_FAILURE);
                 }
 
-                task->run();
+#ifdef PERF_COUNTERS
+                eventfd_t opened;
+                eventfd_read(counting, &opened);
+                close(counting);
+#endif
 
-                exit(EXIT_SUCCESS);
+                // Skip the exit handlers, they would flush the stdio buffers inherited from the scheduler
+                int status = task->run();
+                fflush(stdout);
+                _exit(status);
 
             } 
             else 
             {
+#ifdef PERF_COUNTERS
+                // The child blocks before the task function until the counters are open
+                task->get_perf().open(pid);
+                eventfd_write(counting, 1);
+                close(counting);
+#endif
                 task->set_pid(pid);
                 task->set_state(task_state::running);                
+                add_running(task);
                 task->add_core_run(task->get_cpu_id());
+                uint64_t dispatched = current_time_in_ns();
+                task->mark_dispatched(dispatched);
+                trace_event(dispatched, timeline_dispatch, task, 0);
+
+#ifdef EVENT_DRIVEN
+                task->set_pidfd(m_events->watch_child(pid, task->get_exit_event()));
+#endif
+                m_progress = true;
             }
+#endif
         }
     }
 }
 
 void scheduler::add_task(task *t)
 {
+    t->set_id(m_tasks.size());
     m_tasks.push_back(t);
 
+    auto position = upper_bound(m_monitorOrder.begin(), m_monitorOrder.end(), t, 
+        [](const task* lhs, const task* rhs) { return lhs->get_priority() > rhs->get_priority(); });
+    m_monitorOrder.insert(position, t);
+
+    // Reserve the ready queue once, so pushing fireable tasks never allocates in the loop
+    vector<task*> storage;
+    storage.reserve(m_tasks.size());
+    m_readyQueue = priority_queue<task*, vector<task*>, CompareTask>(CompareTask(), std::move(storage));
+
     return;
 }
 
 void scheduler::add_task(voter *v)
 {
-    m_tasks.push_back(dynamic_cast<task*>(v));
+    add_task(dynamic_cast<task*>(v));
 
     return;
 }
 
 void scheduler::cleanup_scheduler()
 {    
+    for (worker* w : m_workers)
+    {
+        if (w == NULL)
+            continue;
+
+        w->kill_worker(m_events);
+        delete w;
+    }
+
+#ifndef SIMULATION
     for (size_t i = 0; i < m_tasks.size(); i++)
     {
+        // A task that never ran has no process, kill(0) would signal the scheduler itself
+        if (m_tasks[i]->get_pid() <= 0)
+            continue;
+
         kill(m_tasks[i]->get_pid(), SIGTERM);
         waitpid(m_tasks[i]->get_pid(), NULL, 0);
     }
+#endif
 
     for (task* t : m_tasks)
     {
@@ -261,41 +952,22 @@ void scheduler::cleanup_scheduler()
         delete c;
     }
 
+    if (m_readiness != m_events)
+        delete m_readiness;
+
+    delete m_events;
+
+    m_logWriter.stop();
+    m_logWriter.close_trace(NULL, 0);
+
     printf("Scheduler shutting down...\n");
 }
 
 int scheduler::find_core(bool isVoter)
 {
-    // Always skip the first core, this is used for the scheduler
-    int core_id = -1;
-
-    for (int i = 0; i < NUM_OF_CORES; i++)
-    {
-        if (i == SCHEDULER_CORE)
-            continue;
-
-        if (isVoter)
-        {            
-            // If core is inactive and is more reliable
-            if (!m_cores[i]->get_active()) 
-            {
-                if (core_id == -1 || 
-                    m_cores[i]->get_weight() > m_cores[core_id]->get_weight() || 
-                    (m_cores[i]->get_weight() == m_cores[core_id]->get_weight() && m_cores[i]->get_runs() < m_cores[core_id]->get_runs()))
-                {
-                    core_id = i;
-                }
-            }
-        }
-        else
-        {
-            if (!m_cores[i]->get_active() && 
-                (core_id == -1 || m_cores[i]->get_runs() < m_cores[core_id]->get_runs()))
-            {
-                core_id = i;
-            }
-        }
-    }
+    // The scheduler core is not part of the index
+    core *c = isVoter ? m_coreIndex.most_reliable() : m_coreIndex.least_runs();
+    int core_id = (c == NULL) ? -1 : c->get_coreID();
 
     // If no available core found, return
     if (core_id == -1)
@@ -303,7 +975,7 @@ int scheduler::find_core(bool isVoter)
         return -1;
     }
 
-    if (isVoter && m_cores[core_id]->get_weight() < 80)
+    if (isVoter && m_cores[core_id]->get_weight() < MIN_VOTER_CORE_WEIGHT)
     {
         printf("not reliable \n");
         
@@ -316,28 +988,47 @@ int scheduler::find_core(bool isVoter)
     return core_id;
 }
 
+bool scheduler::laggards_free_core(voter *v, bool isWeighted)
+{
+    for (task* laggard : v->get_last_laggards())
+    {
+        if (laggard->get_state() != task_state::running)
+            continue;
+
+        if (!isWeighted || m_cores[laggard->get_cpu_id()]->get_weight() >= MIN_VOTER_CORE_WEIGHT)
+            return true;
+    }
+
+    return false;
+}
+
 bool scheduler::active()
 {
+#if !defined(EVENT_DRIVEN) && !defined(SIMULATION)
     usleep(1000); // Prevents busy loop
+#endif
 
 #ifdef TIME_BASED
-    time_t currentTime = time(NULL);
-
     // Convert current time and activation time to milliseconds
-    long currentTimeMs = currentTime * 1000;
+    long currentTimeMs = current_time_in_ms();
     long activationTimeMs = m_activationTime * 1000;
 
-    cout << "\rCurrent time: " << currentTimeMs - activationTimeMs << " of " << MAX_RUN_TIME << "\t" << std::flush;
+    cout << "\rCurrent time: " << currentTimeMs - activationTimeMs << " of " << CONFIG.run_time << "\t" << std::flush;
 
-    if (currentTimeMs - activationTimeMs < MAX_RUN_TIME)
+    if (currentTimeMs - activationTimeMs < CONFIG.run_time)
         return true;
     else
         return false;
 
 #else    
-    cout << "\rCurrent run: " << m_tasks[0]->get_runs() << " of " << MAX_ITERATIONS <<  "\t" << std::flush;
+#ifdef SIMULATION
+    // Simulated passes are too fast to print each of them
+    if (m_tasks[0]->get_runs() != m_runs)
+#endif
+    cout << "\rCurrent run: " << m_tasks[0]->get_runs() << " of " << CONFIG.iterations <<  "\t" << std::flush;
+    m_runs = m_tasks[0]->get_runs();
 
-    if (m_tasks[0]->get_runs()  >= MAX_ITERATIONS)
+    if (m_tasks[0]->get_runs()  >= CONFIG.iterations)
         return false;
     else
         return true;
@@ -353,24 +1044,40 @@ void scheduler::printResults()
         iterations += m_tasks[i]->get_fails();
         iterations += m_tasks[i]->get_errors();
     
-        printf("Task: %s \t total runs: %d \t successful runs: %d \t failed runs: %d \t error runs: %d \t total task time: %lld \t average task time: %f \t", 
+        printf("Task: %s \t total runs: %d \t successful runs: %d \t failed runs: %d \t error runs: %d \t cancelled runs: %d \t total task time: %lld \t average task time: %f \t", 
             m_tasks[i]->get_name().c_str(),
             iterations,
             m_tasks[i]->get_success(), 
             m_tasks[i]->get_fails(), 
             m_tasks[i]->get_errors(),
+            m_tasks[i]->get_cancelled(),
             m_tasks[i]->getRuntime(),
             static_cast<double>(m_tasks[i]->getRuntime()) / iterations);
     
         m_tasks[i]->print_core_runs();
     }
 
-    for (int i = 0; i < NUM_OF_CORES && i != SCHEDULER_CORE; i++)
+    for (int i = 0; i < (int)m_cores.size(); i++)
+    {
+        if (i == CONFIG.scheduler_core)
+            continue;
+
         printf("Core: %d \t runs: %d \t weight: %f \t state %d \n", m_cores[i]->get_coreID(), m_cores[i]->get_runs(), m_cores[i]->get_weight(), m_cores[i]->get_active());
+    }
 
     for (size_t i = 0; i < m_tasks.size(); i++)
         printf("Task: %s \t state: %d \t input full: %d \t latest result %d \t latest status %d \t Average runtime: %lld \n", 
         m_tasks[i]->get_name().c_str(), m_tasks[i]->get_state(), m_tasks[i]->task_input_full(m_tasks[i]), m_tasks[i]->get_latestResult(), m_tasks[i]->get_latestStatus(), m_tasks[i]->getRuntime());
+
+    for (size_t i = 0; i < m_tasks.size(); i++)
+    {
+        if (!m_tasks[i]->get_voter())
+            continue;
+
+        voter *v = static_cast<voter*>(m_tasks[i]);
+        printf("Voter: %s \t quorum: %d \t votes: %d \t early votes: %d \t laggards: %d \n", 
+        v->get_name().c_str(), v->get_quorum(), v->get_votes(), v->get_early_votes(), v->get_laggards());
+    }
 }
 
 void scheduler::log_results() {
@@ -378,43 +1085,49 @@ void scheduler::log_results() {
     return;
 #endif
 
+    if (!m_logging)
+        return;
+
     long currentTimeMs = current_time_in_ms();
 
     if ((currentTimeMs - m_log_timeout > MAX_LOG_INTERVAL))
     {
-        result r(m_tasks, m_cores, (currentTimeMs - (m_activationTime * 1000)));
-        m_results.push_back(r);
+#ifdef ASYNC_LOGGING
+        m_logWriter.push(currentTimeMs - (m_activationTime * 1000), m_tasks, m_cores);
+#else
+        m_metrics.record(currentTimeMs - (m_activationTime * 1000), m_tasks, m_cores);
+#endif
+        trace_event(timeline_log, NULL, 0);
 
         m_log_timeout = currentTimeMs;
     }
 }
 
-void scheduler::write_results_to_tsv() 
+bool scheduler::create_result_directory()
 {
-#ifndef LOGGING
-    return;
-#endif
-
-    string directoryName = generateOutputString(m_outputDirectory);
+    if (!m_resultDirectory.empty())
+        return true;
 
-    directoryName = "results/" + directoryName;
+    // The directory can be given per run, e.g. by a parameter sweep
+    string directoryName = CONFIG.results.empty() ? "results/" + generateOutputString(m_outputDirectory) : CONFIG.results;
     if (create_directory(directoryName))
-        return;
+        return false;
 
+    m_resultDirectory = directoryName;
+    return true;
+}
+
+void scheduler::write_metrics_to_tsv(const string &directoryName)
+{
     string core_results = directoryName + "/cores.tsv";
     string weight_results = directoryName + "/weights.tsv";
     string task_results = directoryName + "/tasks.tsv";
-    string summary_results = directoryName + "/summary.txt";
 
     FILE *core_file = fopen(core_results.c_str(), "w");
     FILE *weight_file = fopen(weight_results.c_str(), "w");
     FILE *task_file = fopen(task_results.c_str(), "w");
-    FILE *summary_file = fopen(summary_results.c_str(), "w");
 
-    string parameterFile = directoryName + "/parameters.txt";
-    create_parameter_file(parameterFile);
-
-    if (!core_file || !weight_file || !task_file || !summary_file) 
+    if (!core_file || !weight_file || !task_file) 
     {
         perror("Failed to open file");
         return;
@@ -440,13 +1153,15 @@ void scheduler::write_results_to_tsv()
     }
 
     // Task banner
-    for (size_t i = 0; i < m_tasks.size(); i++)
+    size_t loggedTasks = get_logged_tasks();
+
+    for (size_t i = 0; i < loggedTasks; i++)
     {
         if (!i)
             fprintf(task_file, "time\t");
         
         fprintf(task_file, "%s", m_tasks[i]->get_name().c_str());
-        if (i < m_tasks.size() - 1)        
+        if (i < loggedTasks - 1)        
             fprintf(task_file, "\t");
     }
 
@@ -454,16 +1169,16 @@ void scheduler::write_results_to_tsv()
     fprintf(weight_file, "\n");
     fprintf(task_file, "\n");
 
-    for (auto& result : m_results)
+    for (size_t i = 0; i < m_metrics.size(); i++)
     {
-        fprintf(core_file, "%ld\t", result.m_time);
-        fprintf(weight_file, "%ld\t", result.m_time);
-        fprintf(task_file, "%ld\t", result.m_time);
+        fprintf(core_file, "%ld\t", m_metrics.time(i));
+        fprintf(weight_file, "%ld\t", m_metrics.time(i));
+        fprintf(task_file, "%ld\t", m_metrics.time(i));
 
         for (size_t j = 0; j < m_cores.size(); j++)
         {
-            fprintf(core_file, "%d", (result.m_cores[j]));
-            fprintf(weight_file, "%f", (result.m_weights[j]));
+            fprintf(core_file, "%d", m_metrics.core_runs(i, j));
+            fprintf(weight_file, "%f", m_metrics.weight(i, j));
             
             if (j < m_cores.size() - 1) 
             {
@@ -472,11 +1187,11 @@ void scheduler::write_results_to_tsv()
             }
         }
 
-        for (size_t j = 0; j < m_tasks.size(); j++)
+        for (size_t j = 0; j < loggedTasks; j++)
         {
-            fprintf(task_file, "%d", result.m_tasks[j]);
+            fprintf(task_file, "%d", m_metrics.task_success(i, j));
 
-            if (j < m_tasks.size() - 1)
+            if (j < loggedTasks - 1)
                 fprintf(task_file, "\t");
         }
 
@@ -485,6 +1200,199 @@ void scheduler::write_results_to_tsv()
         fprintf(task_file, "\n");
     }
 
+    fclose(core_file);
+    fclose(weight_file);
+    fclose(task_file);
+}
+
+void scheduler::write_latency_to_tsv(const string &directoryName)
+{
+    string latency_results = directoryName + "/latency.tsv";
+    FILE *latency_file = fopen(latency_results.c_str(), "w");
+
+    if (!latency_file)
+    {
+        perror("Failed to open file");
+        return;
+    }
+
+    // All values in nanoseconds
+    fprintf(latency_file, "task\tmetric\tcount\tmin\tmean\tp50\tp90\tp99\tp99.9\tmax\n");
+
+    for (task* t : m_tasks)
+    {
+        for (int m = 0; m < NUM_LATENCY_METRICS; m++)
+        {
+            const latency_histogram &h = t->get_latency((latency_metric)m);
+
+            fprintf(latency_file, "%s\t%s\t%lu\t%lu\t%.0f\t%lu\t%lu\t%lu\t%lu\t%lu\n",
+                t->get_name().c_str(), latency_metric_names[m], h.get_count(), h.get_min(), h.get_mean(),
+                h.percentile(50), h.percentile(90), h.percentile(99), h.percentile(99.9), h.get_max());
+        }
+    }
+
+    fclose(latency_file);
+}
+
+void scheduler::write_e2e_to_tsv(const string &directoryName)
+{
+    if (m_e2e == NULL)
+        return;
+
+    string e2e_results = directoryName + "/e2e.tsv";
+    FILE *e2e_file = fopen(e2e_results.c_str(), "w");
+
+    if (!e2e_file)
+    {
+        perror("Failed to open file");
+        return;
+    }
+
+    // All values in nanoseconds
+    fprintf(e2e_file, "path\tcount\tmin\tmean\tp50\tp90\tp99\tp99.9\tmax\n");
+
+    for (uint32_t p = 1; p <= m_e2e->get_paths(); p++)
+    {
+        const latency_histogram &h = m_e2e->get_latency(p);
+
+        fprintf(e2e_file, "%s\t%lu\t%lu\t%.0f\t%lu\t%lu\t%lu\t%lu\t%lu\n",
+            m_e2e->get_name(p), h.get_count(), h.get_min(), h.get_mean(),
+            h.percentile(50), h.percentile(90), h.percentile(99), h.percentile(99.9), h.get_max());
+    }
+
+    fclose(e2e_file);
+}
+
+void scheduler::write_counters_to_tsv(const string &directoryName)
+{
+#ifndef PERF_COUNTERS
+    return;
+#endif
+
+    string counter_results = directoryName + "/counters.tsv";
+    FILE *counter_file = fopen(counter_results.c_str(), "w");
+
+    if (!counter_file)
+    {
+        perror("Failed to open file");
+        return;
+    }
+
+    // The hardware counters are "-" if they could not be opened
+    bool hardware = perf_counters::get_support() == counters_hardware;
+
+    fprintf(counter_file, "name\tjobs");
+    for (int i = 0; i < NUM_COUNTERS; i++)
+        fprintf(counter_file, "\t%s", counter_names[i]);
+    fprintf(counter_file, "\tipc\n");
+
+    auto write_row = [&](const string &name, const counter_totals &totals)
+    {
+        fprintf(counter_file, "%s\t%lu", name.c_str(), totals.jobs);
+
+        for (int i = 0; i < NUM_COUNTERS; i++)
+        {
+            if (!hardware && i < counter_context_switches)
+                fprintf(counter_file, "\t-");
+            else
+                fprintf(counter_file, "\t%lu", totals.value[i]);
+        }
+
+        if (hardware && totals.value[counter_cycles])
+            fprintf(counter_file, "\t%.3f\n", (double)totals.value[counter_instructions] / totals.value[counter_cycles]);
+        else
+            fprintf(counter_file, "\t-\n");
+    };
+
+    for (task* t : m_tasks)
+        write_row(t->get_name(), t->get_counters());
+
+    for (core* c : m_cores)
+    {
+        if (c->get_coreID() != CONFIG.scheduler_core)
+            write_row("core_" + to_string(c->get_coreID()), c->get_counters());
+    }
+
+    fclose(counter_file);
+}
+
+void scheduler::write_usage_to_tsv(const string &directoryName)
+{
+    string usage_results = directoryName + "/rusage.tsv";
+    FILE *usage_file = fopen(usage_results.c_str(), "w");
+
+    if (!usage_file)
+    {
+        perror("Failed to open file");
+        return;
+    }
+
+    fprintf(usage_file, "name\tjobs\tuser_ms\tsystem_ms\tcpu_ms_per_job\tminor_faults\tmajor_faults\tvoluntary_switches\tinvoluntary_switches\n");
+
+    auto write_row = [&](const string &name, const usage_totals &totals)
+    {
+        const job_usage &u = totals.usage;
+        double cpu_per_job = totals.jobs ? (u.user_us + u.system_us) / 1000.0 / totals.jobs : 0;
+
+        fprintf(usage_file, "%s\t%lu\t%.3f\t%.3f\t%.3f\t%lu\t%lu\t%lu\t%lu\n",
+            name.c_str(), totals.jobs, u.user_us / 1000.0, u.system_us / 1000.0, cpu_per_job,
+            u.minor_faults, u.major_faults, u.voluntary_switches, u.involuntary_switches);
+    };
+
+    for (task* t : m_tasks)
+        write_row(t->get_name(), t->get_usage());
+
+    for (core* c : m_cores)
+    {
+        if (c->get_coreID() != CONFIG.scheduler_core)
+            write_row("core_" + to_string(c->get_coreID()), c->get_usage());
+    }
+
+    fclose(usage_file);
+}
+
+void scheduler::write_results_to_tsv() 
+{
+#ifndef LOGGING
+    return;
+#endif
+
+    if (!create_result_directory())
+        return;
+
+    string directoryName = m_resultDirectory;
+    string summary_results = directoryName + "/summary.txt";
+
+    // The summary is written in memory first, so it can be stored at the end of a trace as well
+    char *summary = NULL;
+    size_t summary_size = 0;
+    FILE *summary_file = open_memstream(&summary, &summary_size);
+
+    string parameterFile = directoryName + "/parameters.txt";
+    create_parameter_file(parameterFile);
+
+    if (!summary_file) 
+    {
+        perror("open_memstream");
+        return;
+    }
+
+#ifdef ASYNC_LOGGING
+    // The samples were streamed while the scheduler ran
+    m_logWriter.stop();
+#else
+    write_metrics_to_tsv(directoryName);
+#endif
+
+    write_latency_to_tsv(directoryName);
+    write_e2e_to_tsv(directoryName);
+    write_counters_to_tsv(directoryName);
+    write_usage_to_tsv(directoryName);
+
+#ifdef EVENT_TRACE
+    m_timeline.write_json(directoryName + "/trace.json", m_tasks, m_cores.size());
+#endif
+
 
     for (size_t i = 0; i < m_tasks.size(); i++)
     {
@@ -493,12 +1401,13 @@ void scheduler::write_results_to_tsv()
         iterations += m_tasks[i]->get_fails();
         iterations += m_tasks[i]->get_errors();
     
-        fprintf(summary_file, "Task: %s \t total runs: %d \t successful runs: %d \t failed runs: %d \t error runs: %d \t total task time: %lld \t average task time: %.2f \t", 
+        fprintf(summary_file, "Task: %s \t total runs: %d \t successful runs: %d \t failed runs: %d \t error runs: %d \t cancelled runs: %d \t total task time: %lld \t average task time: %.2f \t", 
             m_tasks[i]->get_name().c_str(),
             iterations,
             m_tasks[i]->get_success(),
             m_tasks[i]->get_fails(),
             m_tasks[i]->get_errors(),
+            m_tasks[i]->get_cancelled(),
             m_tasks[i]->getRuntime(),
             static_cast<double>(m_tasks[i]->getRuntime()) / iterations);
     
@@ -506,8 +1415,13 @@ void scheduler::write_results_to_tsv()
     }
     
 
-    for (int i = 0; i < NUM_OF_CORES && i != SCHEDULER_CORE; i++)
+    for (int i = 0; i < (int)m_cores.size(); i++)
+    {
+        if (i == CONFIG.scheduler_core)
+            continue;
+
         fprintf(summary_file, "Core: %d \t runs: %d \t weight: %f \t state %d \n", m_cores[i]->get_coreID(), m_cores[i]->get_runs(), m_cores[i]->get_weight(), m_cores[i]->get_active());
+    }
 
         
     for (size_t i = 0; i < m_tasks.size(); i++)
@@ -520,10 +1434,96 @@ void scheduler::write_results_to_tsv()
         m_tasks[i]->get_latestStatus());
     }
 
-    fclose(core_file);
-    fclose(weight_file);
-    fclose(task_file);
+    for (size_t i = 0; i < m_tasks.size(); i++)
+    {
+        if (!m_tasks[i]->get_voter())
+            continue;
+
+        voter *v = static_cast<voter*>(m_tasks[i]);
+        fprintf(summary_file, "Voter: %s \t quorum: %d \t votes: %d \t early votes: %d \t laggards: %d \n", 
+        v->get_name().c_str(), v->get_quorum(), v->get_votes(), v->get_early_votes(), v->get_laggards());
+    }
+
+    for (task* t : m_tasks)
+    {
+        for (int m = 0; m < NUM_LATENCY_METRICS; m++)
+        {
+            const latency_histogram &h = t->get_latency((latency_metric)m);
+
+            if (!h.get_count())
+                continue;
+
+            fprintf(summary_file, "Latency: %s \t %s \t count: %lu \t p50: %.1f us \t p90: %.1f us \t p99: %.1f us \t p99.9: %.1f us \t max: %.1f us \n",
+            t->get_name().c_str(), latency_metric_names[m], h.get_count(),
+            h.percentile(50) / 1000.0, h.percentile(90) / 1000.0, h.percentile(99) / 1000.0, h.percentile(99.9) / 1000.0, h.get_max() / 1000.0);
+        }
+    }
+
+    if (m_e2e != NULL)
+    {
+        for (uint32_t p = 1; p <= m_e2e->get_paths(); p++)
+        {
+            const latency_histogram &h = m_e2e->get_latency(p);
+
+            fprintf(summary_file, "E2E: %s \t count: %lu \t p50: %.1f us \t p90: %.1f us \t p99: %.1f us \t p99.9: %.1f us \t max: %.1f us \n",
+            m_e2e->get_name(p), h.get_count(),
+            h.percentile(50) / 1000.0, h.percentile(90) / 1000.0, h.percentile(99) / 1000.0, h.percentile(99.9) / 1000.0, h.get_max() / 1000.0);
+        }
+
+        fprintf(summary_file, "E2E: lost chains: %lu \t repeated chains: %lu \n", m_e2e->get_lost(), m_e2e->get_repeated());
+    }
+
+    for (task* t : m_tasks)
+    {
+        const usage_totals &totals = t->get_usage();
+
+        if (!totals.jobs)
+            continue;
+
+        // CPU time below the wall time means the job waited or was preempted
+        fprintf(summary_file, "Usage: %s \t jobs: %lu \t cpu time per job: %.2f ms \t page faults per job: %.1f \t preemptions per job: %.1f \n",
+        t->get_name().c_str(), totals.jobs,
+        (totals.usage.user_us + totals.usage.system_us) / 1000.0 / totals.jobs,
+        (double)(totals.usage.minor_faults + totals.usage.major_faults) / totals.jobs,
+        (double)totals.usage.involuntary_switches / totals.jobs);
+    }
+
+    fprintf(summary_file, "Tick: passes: %lu \t mean: %.1f us \t p50: %.1f us \t p99: %.1f us \t max: %.1f us \n",
+    m_tickCost.get_count(), m_tickCost.get_mean() / 1000.0,
+    m_tickCost.percentile(50) / 1000.0, m_tickCost.percentile(99) / 1000.0, m_tickCost.get_max() / 1000.0);
+
+#ifdef PERF_COUNTERS
+    const char *support[] = { "no jobs counted", "hardware and software", "software only", "unavailable" };
+    fprintf(summary_file, "Counters: %s \n", support[perf_counters::get_support()]);
+#endif
+
+#ifdef EVENT_TRACE
+    fprintf(summary_file, "Timeline: events: %zu \t overwritten events: %lu \n", m_timeline.size(), m_timeline.get_overwritten());
+#endif
+
+#ifdef ASYNC_LOGGING
+    fprintf(summary_file, "Log: samples: %lu \t dropped samples: %lu \n", m_logWriter.get_written(), m_logWriter.get_dropped());
+#else
+    fprintf(summary_file, "Log: samples: %zu \t overwritten samples: %zu \n", m_metrics.size(), m_metrics.get_dropped());
+#endif
+
     fclose(summary_file);
+
+    FILE *summary_out = fopen(summary_results.c_str(), "w");
+
+    if (summary_out)
+    {
+        fwrite(summary, 1, summary_size, summary_out);
+        fclose(summary_out);
+    }
+    else
+        perror("Failed to open file");
+
+#ifdef ASYNC_LOGGING
+    m_logWriter.close_trace(summary, summary_size);
+#endif
+
+    free(summary);
 }
 
 void scheduler::create_parameter_file(string &path)
@@ -534,23 +1534,25 @@ void scheduler::create_parameter_file(string &path)
         return;
 
     fprintf(injection_file, "*** Parameter file *** \n");
-    fprintf(injection_file, "task busy time: %d \n", TASK_BUSY_TIME);
+    fprintf(injection_file, "scheduler: %s \n", m_outputDirectory.c_str());
+    fprintf(injection_file, "task busy time: %d \n", CONFIG.busy_time);
     fprintf(injection_file, "max read time: %d \n", MAX_READ_TIME);
 #ifdef ITERATION_BASED
-    fprintf(injection_file, "iterations: %d \n", MAX_ITERATIONS);
-#elif
-    fprintf(injection_file, "run time: %d \n", MAX_RUN_TIME);
+    fprintf(injection_file, "iterations: %ld \n", CONFIG.iterations);
+#else
+    fprintf(injection_file, "run time: %ld \n", CONFIG.run_time);
 #endif
-    fprintf(injection_file, "cores: %d \n", NUM_OF_CORES);
+    fprintf(injection_file, "cores: %d \n", CONFIG.cores);
 
     for (core* c : m_cores)
     {
         fprintf(injection_file, "\t core: %d \n", c->get_coreID());
     }
 
-    fprintf(injection_file, "scheduler core: %d \n", SCHEDULER_CORE);
-    fprintf(injection_file, "core buffer: %d \n", CORE_BUFFER_SIZE);
-    fprintf(injection_file, "max stuck time: %d \n\n", MAX_STUCK_TIME);
+    fprintf(injection_file, "scheduler core: %d \n", CONFIG.scheduler_core);
+    fprintf(injection_file, "first cpu: %d \n", CONFIG.cpu_base);
+    fprintf(injection_file, "core buffer: %d \n", CONFIG.buffer_size);
+    fprintf(injection_file, "max stuck time: %d \n\n", CONFIG.stuck_time);
     fprintf(injection_file, "Task descriptions: \n");
     fprintf(injection_file, "Name: \t Offset \t Period: \t Priority: \n");
     for (task* t : m_tasks)
@@ -563,11 +1565,31 @@ void scheduler::create_parameter_file(string &path)
 
 long scheduler::current_time_in_ms() 
 {
+#ifdef SIMULATION
+    return m_virtualTime;
+#endif
+
     struct timespec spec;
     clock_gettime(CLOCK_REALTIME, &spec);
     return (spec.tv_sec * 1000) + (spec.tv_nsec / 1000000);
 }
 
+uint64_t scheduler::current_time_in_ns()
+{
+#ifdef SIMULATION
+    return (uint64_t)m_virtualTime * 1000000;
+#endif
+
+    return monotonic_ns();
+}
+
+uint64_t scheduler::monotonic_ns()
+{
+    struct timespec spec;
+    clock_gettime(CLOCK_MONOTONIC, &spec);
+    return ((uint64_t)spec.tv_sec * 1000000000) + spec.tv_nsec;
+}
+
 string scheduler::generateOutputString(const string& prefix) 
 {
     // Get the current time
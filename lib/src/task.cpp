@@ -4,7 +4,6 @@
 #include <sstream>
 #include <pthread.h>
 #include <unistd.h>
-#include <sys/select.h>
 #include "defines.h"
 
 #include "task.h"
@@ -22,29 +21,89 @@ task::task(const string& name, unsigned long int period, unsigned long int offse
     // Set only cyclic tasks to be fireable from the start
     period ? m_fireable = true : m_fireable = false;
 
-    for (int i = 0; i < NUM_OF_CORES; i++)
+    for (int i = 0; i < MAX_CORES; i++)
         m_coreRuns[i] = 0;
 }
 
-bool task::offset_elapsed(unsigned long int startTime, unsigned long int currentTime)
+task::~task()
 {
-    if (!m_offset || currentTime - startTime > m_offset)
-        return true;
-    
-    return false;
+    while (m_outputs != NULL)
+    {
+        output *next = m_outputs->next;
+        free(m_outputs);
+        m_outputs = next;
+    }
 }
 
-bool task::period_elapsed(unsigned long int currentTime)
+task *task::s_current = NULL;
+
+const char *latency_metric_names[NUM_LATENCY_METRICS] = { "dispatch", "execution", "response", "jitter" };
+
+void task_exit(int status)
 {
-    if (!m_period || currentTime - m_startTime > m_period)
-        return true;
+    throw task_exit_status { status };
+}
 
-    return false;
+void task_vote(uint32_t chain, uint64_t digest)
+{
+    task *t = task::get_current();
+
+    if (t == NULL || t->get_ballot() == NULL)
+        return;
+
+    ballot *b = t->get_ballot();
+    b->chain = chain;
+    b->digest = digest;
+    b->run.store(t->get_runs(), std::memory_order_release);
+}
+
+int task::run()
+{
+    s_current = this;
+
+    if (m_function == NULL)
+        return EXIT_SUCCESS;
+
+    try
+    {
+        m_function();
+    }
+    catch (const task_exit_status &e)
+    {
+        return e.status;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+void task::mark_dispatched(uint64_t now)
+{
+    if (!m_readyNs)
+        m_readyNs = now;
+
+    m_latency[latency_dispatch].record(now - m_readyNs);
+
+    if (m_period && m_dispatchNs)
+    {
+        int64_t deviation = (int64_t)(now - m_dispatchNs) - (int64_t)m_period * 1000000;
+        m_latency[latency_jitter].record(deviation < 0 ? -deviation : deviation);
+    }
+
+    m_runReleaseNs = (m_releaseNs && m_releaseNs <= m_readyNs) ? m_releaseNs : m_readyNs;
+    m_dispatchNs = now;
+    m_releaseNs = 0;
+    m_readyNs = 0;
+}
+
+void task::mark_completed(uint64_t now)
+{
+    m_latency[latency_execution].record(now - m_dispatchNs);
+    m_latency[latency_response].record(now - m_runReleaseNs);
 }
 
 bool task::is_stuck(unsigned long int elapsedTime, int status, pid_t result)
 {
-    if (elapsedTime - m_startTime > MAX_STUCK_TIME  && m_latestResult == result && m_latestStatus == status)
+    if (elapsedTime - m_startTime > (unsigned long)CONFIG.stuck_time &&  m_latestResult == result && m_latestStatus == status)
         return true;
 
     return false;
@@ -52,28 +111,58 @@ bool task::is_stuck(unsigned long int elapsedTime, int status, pid_t result)
 
 void task::add_input(Pipe *p, int size) 
 {
-    input *new_input = (input *)malloc(sizeof(input));
+    m_inputs.add(p->get_read_fd(), size, p, NULL);
+}
+
+void task::add_input(Channel *c, int size) 
+{
+    m_inputs.add(c->get_notify_fd(), size, NULL, c);
+}
+
+void task::add_output(Pipe *p) 
+{
+    output *new_output = (output *)malloc(sizeof(output));
 
-    if (new_input == NULL) 
+    if (new_output == NULL) 
     {
-        perror("Failed to allocate memory for new input");
+        perror("Failed to allocate memory for new output");
         exit(EXIT_FAILURE);
     }
 
-    new_input->fd = p->get_read_fd();
-    new_input->next = NULL;
-    new_input->size = size;
+    new_output->pipe = p;
+    new_output->channel = NULL;
+    new_output->next = m_outputs;
 
-    if (m_inputs == NULL)
-        m_inputs = new_input;
-    else
-    {
-        input *current = m_inputs;
-        while (current->next != NULL)
-            current = current->next;
+    m_outputs = new_output;
+}
+
+void task::add_output(Channel *c) 
+{
+    output *new_output = (output *)malloc(sizeof(output));
 
-        current->next = new_input;
+    if (new_output == NULL) 
+    {
+        perror("Failed to allocate memory for new output");
+        exit(EXIT_FAILURE);
     }
+
+    new_output->pipe = NULL;
+    new_output->channel = c;
+    new_output->next = m_outputs;
+
+    m_outputs = new_output;
+}
+
+void task::take_input_tokens()
+{
+    for (size_t i = 0; i < m_inputs.size(); i++)
+        m_inputs.get_channel(i) != NULL ? m_inputs.get_channel(i)->take_token() : m_inputs.get_pipe(i)->take_token();
+}
+
+void task::add_output_tokens()
+{
+    for (output *current = m_outputs; current != NULL; current = current->next)
+        current->channel != NULL ? current->channel->add_token() : current->pipe->add_token();
 }
 
 task* task::declare_task(const string& name, unsigned long int period, unsigned long int offset, int priority, void (*function)(void))
@@ -92,59 +181,38 @@ bool task::task_input_full(task *t)
 
         return v->get_voter_fireable();
     } 
+#ifdef SIMULATION
     else
     {
-        fd_set read_fds;
-        struct timeval timeout;
-        int max_fd = 0;
-        input *current = t->get_inputs();
-
-        FD_ZERO(&read_fds);
-        
-        while (current != NULL) 
-        {
-            if (current->fd < 0) 
-            {
-                fprintf(stderr, "Invalid file descriptor: %d\n", current->fd);                
-                return false;
-            }
-
-            FD_SET(current->fd, &read_fds);
+        // Simulated tasks exchange tokens instead of data
+        input_table &inputs = t->get_inputs();
 
-            if (current->fd > max_fd)
-                max_fd = current->fd;
-
-            current = current->next;
-        }
-        
-        timeout.tv_sec = 0;
-        timeout.tv_usec = 0;
-        
-        int result = select(max_fd + 1, &read_fds, NULL, NULL, &timeout);
-
-        if (result < 0)
+        for (size_t i = 0; i < inputs.size(); i++)
         {
-            perror("select");
-            return false;
+            if ((inputs.get_channel(i) != NULL ? inputs.get_channel(i)->get_tokens() : inputs.get_pipe(i)->get_tokens()) == 0)
+                return false;
         }
+    }
+#else
+    else
+    {
+        // The bits are set by the input events, only the first check after a run probes the data that is left.
+        // The inputs of a running task are not probed, its job may be reading them
+        input_table &inputs = t->get_inputs();
 
-        current = t->get_inputs();
-
-        while (current != NULL) 
-        {
-            if (!FD_ISSET(current->fd, &read_fds))
-                return false;
+        if (!inputs.full() && t->get_state() != task_state::running)
+            inputs.refresh();
 
-            current = current->next;
-        }
+        return inputs.full();
     }
+#endif
 
     return true;
 }
 
 void task::print_core_runs() 
 {            
-    for (int i = 0; i < NUM_OF_CORES; i++)
+    for (int i = 0; i < CONFIG.cores; i++)
         printf("Core %d: %d \t", i, m_coreRuns[i]);
     
     printf("\n");
@@ -154,7 +222,7 @@ string task::write_core_runs() const
 {
     ostringstream result;
     
-    for (int i = 0; i < NUM_OF_CORES; i++) {
+    for (int i = 0; i < CONFIG.cores; i++) {
         result << "Core " << i << ": " << m_coreRuns[i] << "\t";
     }
 
@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#include <timeline.h>
+#include <task.h>
+
+timeline::~timeline()
+{
+    if (m_ring != NULL)
+        munmap(m_ring, m_slots * sizeof(timeline_record));
+}
+
+void timeline::init(size_t slots, uint64_t start)
+{
+    void *memory = mmap(NULL, slots * sizeof(timeline_record), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        perror("mmap");
+        exit(EXIT_FAILURE);
+    }
+
+    // The ring is populated up front, so recording never faults. Every fork() would copy its page tables though
+    if (madvise(memory, slots * sizeof(timeline_record), MADV_DONTFORK) != 0)
+        perror("madvise");
+
+    m_ring = static_cast<timeline_record*>(memory);
+    m_slots = slots;
+    m_next = 0;
+    m_count = 0;
+    m_overwritten = 0;
+    m_start = start;
+}
+
+// Task names come from graph files, so quotes, backslashes and control characters are escaped
+static string json_escape(const string &text)
+{
+    string escaped;
+
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", (unsigned char)c);
+            escaped += code;
+        }
+        else
+            escaped += c;
+    }
+
+    return escaped;
+}
+
+bool timeline::write_json(const string &path, const vector<task*> &tasks, int cores)
+{
+    FILE *file = fopen(path.c_str(), "w");
+
+    if (!file)
+    {
+        perror("Failed to open file");
+        return false;
+    }
+
+    // Process 1 has a track per core plus one for the scheduler itself, process 2 a track per task
+    int scheduler_track = cores;
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"cores\"}},\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"args\":{\"name\":\"tasks\"}},\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"scheduler\"}}", scheduler_track);
+
+    for (int c = 0; c < cores; c++)
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"core_%d\"}}", c, c);
+
+    vector<string> names;
+
+    for (task *t : tasks)
+        names.push_back(json_escape(t->get_name()));
+
+    for (size_t t = 0; t < tasks.size(); t++)
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":2,\"tid\":%zu,\"args\":{\"name\":\"%s\"}}", t, names[t].c_str());
+
+    // The dispatch of the run each task is in, its slice is written when the run ends
+    vector<timeline_record> dispatched(tasks.size());
+    vector<bool> running(tasks.size(), false);
+
+    auto ts = [&](uint64_t time) { return (time - m_start) / 1000.0; };
+
+    auto name_of = [&](int t) { return (t >= 0 && (size_t)t < tasks.size()) ? names[t] : string("unknown"); };
+
+    auto instant = [&](const char *name, int pid, int tid, uint64_t time, const char *arg, int value)
+    {
+        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f", name, pid, tid, ts(time));
+
+        if (arg != NULL)
+            fprintf(file, ",\"args\":{\"%s\":%d}", arg, value);
+
+        fprintf(file, "}");
+    };
+
+    auto slice = [&](const timeline_record &start, uint64_t end, const char *result, int status)
+    {
+        string name = name_of(start.task);
+
+        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"result\":\"%s\",\"status\":%d}}",
+            name.c_str(), start.core, ts(start.time), (end - start.time) / 1000.0, result, status);
+        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":2,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"result\":\"%s\",\"status\":%d,\"core\":%d}}",
+            name.c_str(), start.task, ts(start.time), (end - start.time) / 1000.0, result, status, start.core);
+    };
+
+    for (size_t i = 0; i < m_count; i++)
+    {
+        const timeline_record &r = m_ring[(m_next + m_slots - m_count + i) % m_slots];
+        bool known = r.task >= 0 && (size_t)r.task < tasks.size();
+
+        switch (r.type)
+        {
+            case timeline_release:
+                instant("release", 2, r.task, r.time, NULL, 0);
+                break;
+            case timeline_dispatch:
+                if (known)
+                {
+                    dispatched[r.task] = r;
+                    running[r.task] = true;
+                }
+                break;
+            case timeline_completion:
+            case timeline_crash:
+            case timeline_cancel:
+            {
+                const char *result = (r.type == timeline_completion) ? "success" : (r.type == timeline_crash) ? "crash" : "cancelled";
+
+                // The dispatch may have been overwritten
+                if (known && running[r.task])
+                {
+                    slice(dispatched[r.task], r.time, result, r.value);
+                    running[r.task] = false;
+                }
+                else
+                    instant(result, 2, r.task, r.time, "status", r.value);
+                break;
+            }
+            case timeline_stuck:
+                instant("stuck", 2, r.task, r.time, NULL, 0);
+                break;
+            case timeline_vote:
+                instant("vote", 2, r.task, r.time, "laggards", r.value);
+                break;
+            case timeline_log:
+                instant("log", 1, scheduler_track, r.time, NULL, 0);
+                break;
+        }
+    }
+
+    // Runs that did not end before the scheduler stopped
+    for (size_t t = 0; t < tasks.size(); t++)
+    {
+        if (!running[t])
+            continue;
+
+        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"B\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}", name_of(t).c_str(), dispatched[t].core, ts(dispatched[t].time));
+        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"B\",\"pid\":2,\"tid\":%zu,\"ts\":%.3f}", name_of(t).c_str(), t, ts(dispatched[t].time));
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    return true;
+}
@@ -0,0 +1,320 @@
+#include <string.h>
+#include <algorithm>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <trace.h>
+#include <message.h>
+
+static void put_varint(vector<uint8_t> &out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+
+    out.push_back((uint8_t)value);
+}
+
+static bool get_varint(const uint8_t *&cursor, const uint8_t *end, uint64_t &value)
+{
+    value = 0;
+
+    for (int shift = 0; shift < 64 && cursor < end; shift += 7)
+    {
+        uint8_t byte = *cursor++;
+        value |= (uint64_t)(byte & 0x7f) << shift;
+
+        if (!(byte & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+static uint64_t zigzag(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t unzigzag(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+bool trace_writer::open(const string &path, const vector<string> &names, size_t cores)
+{
+    m_file = fopen(path.c_str(), "wb");
+
+    if (!m_file)
+    {
+        perror("Failed to open file");
+        return false;
+    }
+
+    m_numCores = cores;
+    m_numTasks = names.size();
+
+    trace_header header = { TRACE_MAGIC, TRACE_VERSION, (uint16_t)cores, (uint16_t)names.size(), TRACE_WEIGHT_SCALE, 0 };
+    fwrite(&header, sizeof(header), 1, m_file);
+
+    for (const string &name : names)
+    {
+        char buffer[TRACE_NAME_SIZE] = { 0 };
+        strncpy(buffer, name.c_str(), TRACE_NAME_SIZE - 1);
+        fwrite(buffer, TRACE_NAME_SIZE, 1, m_file);
+    }
+
+    size_t fields = 2 * m_numCores + m_numTasks;
+
+    // Worst case of a sample: a 10 byte time, the bitmap and a 10 byte delta per field
+    m_block.reserve(TRACE_BLOCK_SAMPLES * (10 + (fields + 7) / 8 + 10 * fields));
+    m_prev.assign(fields, 0);
+    m_delta.assign(fields, 0);
+    m_count = 0;
+    m_prevTime = 0;
+
+    return true;
+}
+
+void trace_writer::add_sample(long time, const int *core_runs, const float *weights, const int *task_success)
+{
+    if (!m_file)
+        return;
+
+    size_t fields = m_prev.size();
+
+    put_varint(m_block, zigzag(time - m_prevTime));
+    m_prevTime = time;
+
+    // Reserve the bitmap, it is filled in while computing the deltas
+    size_t bitmap = m_block.size();
+    m_block.resize(bitmap + (fields + 7) / 8, 0);
+
+    for (size_t i = 0; i < fields; i++)
+    {
+        int64_t value;
+
+        if (i < m_numCores)
+            value = core_runs[i];
+        else if (i < 2 * m_numCores)
+            value = llround(weights[i - m_numCores] * TRACE_WEIGHT_SCALE);
+        else
+            value = task_success[i - 2 * m_numCores];
+
+        m_delta[i] = value - m_prev[i];
+        m_prev[i] = value;
+
+        if (m_delta[i])
+            m_block[bitmap + i / 8] |= (uint8_t)(1 << (i % 8));
+    }
+
+    for (size_t i = 0; i < fields; i++)
+    {
+        if (m_delta[i])
+            put_varint(m_block, zigzag(m_delta[i]));
+    }
+
+    if (++m_count == TRACE_BLOCK_SAMPLES)
+        flush_block();
+}
+
+void trace_writer::flush_block()
+{
+    if (!m_count)
+        return;
+
+    write_frame(trace_samples, m_count, m_block.data(), m_block.size());
+
+    // The next block starts from scratch, so it can be decoded on its own
+    m_block.clear();
+    m_count = 0;
+    m_prevTime = 0;
+    fill(m_prev.begin(), m_prev.end(), 0);
+}
+
+void trace_writer::flush()
+{
+    if (!m_file)
+        return;
+
+    flush_block();
+    fflush(m_file);
+}
+
+void trace_writer::write_frame(uint8_t type, uint16_t count, const void *payload, size_t size)
+{
+    trace_frame frame = { TRACE_FRAME_MAGIC, type, 0, count, (uint32_t)size, message_checksum(payload, size) };
+
+    fwrite(&frame, sizeof(frame), 1, m_file);
+
+    if (size)
+        fwrite(payload, 1, size, m_file);
+}
+
+void trace_writer::close(const char *summary, size_t size)
+{
+    if (!m_file)
+        return;
+
+    flush_block();
+
+    if (summary != NULL)
+        write_frame(trace_summary, 0, summary, size);
+
+    write_frame(trace_end, 0, NULL, 0);
+
+    fclose(m_file);
+    m_file = NULL;
+}
+
+trace_reader::~trace_reader()
+{
+    if (m_data != NULL)
+        munmap((void*)m_data, m_size);
+}
+
+bool trace_reader::open(const string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd == -1)
+    {
+        perror("open");
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(trace_header))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (data == MAP_FAILED)
+    {
+        perror("mmap");
+        return false;
+    }
+
+    m_data = (const uint8_t*)data;
+    m_size = st.st_size;
+
+    memcpy(&m_header, m_data, sizeof(m_header));
+
+    if (m_header.magic != TRACE_MAGIC || m_header.version != TRACE_VERSION ||
+        sizeof(m_header) + (size_t)m_header.tasks * TRACE_NAME_SIZE > m_size)
+        return false;
+
+    m_offset = sizeof(m_header);
+
+    for (int i = 0; i < m_header.tasks; i++)
+    {
+        char name[TRACE_NAME_SIZE + 1] = { 0 };
+        memcpy(name, m_data + m_offset, TRACE_NAME_SIZE);
+        m_names.push_back(name);
+        m_offset += TRACE_NAME_SIZE;
+    }
+
+    m_prev.assign(2 * m_header.cores + m_header.tasks, 0);
+    return true;
+}
+
+bool trace_reader::next_block()
+{
+    while (m_offset + sizeof(trace_frame) <= m_size)
+    {
+        trace_frame frame;
+        memcpy(&frame, m_data + m_offset, sizeof(frame));
+
+        const uint8_t *payload = m_data + m_offset + sizeof(frame);
+
+        if (frame.magic != TRACE_FRAME_MAGIC || m_offset + sizeof(frame) + frame.size > m_size ||
+            message_checksum(payload, frame.size) != frame.checksum)
+        {
+            fprintf(stderr, "Corrupt trace block at offset %zu\n", m_offset);
+            return false;
+        }
+
+        m_offset += sizeof(frame) + frame.size;
+
+        switch (frame.type)
+        {
+            case trace_samples:
+                m_cursor = payload;
+                m_remaining = frame.count;
+                m_prevTime = 0;
+                fill(m_prev.begin(), m_prev.end(), 0);
+                return true;
+            case trace_summary:
+                m_summary = (const char*)payload;
+                m_summarySize = frame.size;
+                break;
+            case trace_end:
+                m_offset = m_size;
+                return false;
+            default:
+                // Unknown blocks are skipped
+                break;
+        }
+    }
+
+    return false;
+}
+
+bool trace_reader::next_sample(trace_sample &sample)
+{
+    if (!m_remaining && !next_block())
+        return false;
+
+    const uint8_t *end = m_data + m_offset;
+    size_t cores = m_header.cores;
+    size_t fields = m_prev.size();
+    uint64_t value;
+
+    if (!get_varint(m_cursor, end, value))
+        return false;
+
+    m_prevTime += unzigzag(value);
+
+    const uint8_t *bitmap = m_cursor;
+    m_cursor += (fields + 7) / 8;
+
+    if (m_cursor > end)
+        return false;
+
+    for (size_t i = 0; i < fields; i++)
+    {
+        if (!(bitmap[i / 8] & (1 << (i % 8))))
+            continue;
+
+        if (!get_varint(m_cursor, end, value))
+            return false;
+
+        m_prev[i] += unzigzag(value);
+    }
+
+    sample.time = m_prevTime;
+    sample.core_runs.resize(cores);
+    sample.weights.resize(cores);
+    sample.task_success.resize(m_header.tasks);
+
+    for (size_t i = 0; i < cores; i++)
+    {
+        sample.core_runs[i] = m_prev[i];
+        sample.weights[i] = (float)m_prev[cores + i] / m_header.weight_scale;
+    }
+
+    for (size_t i = 0; i < m_header.tasks; i++)
+        sample.task_success[i] = m_prev[2 * cores + i];
+
+    m_remaining--;
+    return true;
+}
@@ -0,0 +1,38 @@
+#include <string.h>
+
+#include <usage.h>
+
+static uint64_t to_us(const struct timeval &tv)
+{
+    return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+job_usage usage_from_rusage(const struct rusage &after, const struct rusage *before)
+{
+    struct rusage zero;
+    memset(&zero, 0, sizeof(zero));
+
+    if (before == NULL)
+        before = &zero;
+
+    job_usage usage;
+    usage.user_us = to_us(after.ru_utime) - to_us(before->ru_utime);
+    usage.system_us = to_us(after.ru_stime) - to_us(before->ru_stime);
+    usage.minor_faults = after.ru_minflt - before->ru_minflt;
+    usage.major_faults = after.ru_majflt - before->ru_majflt;
+    usage.voluntary_switches = after.ru_nvcsw - before->ru_nvcsw;
+    usage.involuntary_switches = after.ru_nivcsw - before->ru_nivcsw;
+
+    return usage;
+}
+
+void add_usage(usage_totals &totals, const job_usage &job)
+{
+    totals.jobs++;
+    totals.usage.user_us += job.user_us;
+    totals.usage.system_us += job.system_us;
+    totals.usage.minor_faults += job.minor_faults;
+    totals.usage.major_faults += job.major_faults;
+    totals.usage.voluntary_switches += job.voluntary_switches;
+    totals.usage.involuntary_switches += job.involuntary_switches;
+}
@@ -1,3 +1,8 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <sys/mman.h>
+
 #include <voter.h>
 
 voter::voter(const string& name, int period, int offset, int priority, void (*function)(void), voter_type type)
@@ -15,8 +20,67 @@ voter* voter::declare_voter(const string& name, int period, int offset, int prio
 
 void voter::add_replicate(task *t)
 {
+    // The job of the replicate casts its ballot in its own process
+    void *memory = mmap(NULL, sizeof(ballot), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        perror("mmap");
+        exit(EXIT_FAILURE);
+    }
+
+    ballot *b = new (memory) ballot();
+    b->run.store(0, std::memory_order_relaxed);
+    t->set_ballot(b);
+
     m_replicates.push_back(t);
-    m_replicateMonitor.push_back({t->get_name(), false});
+    m_replicateMonitor.push_back({t->get_name(), false, -1});
+}
+
+int voter::count_agreeing()
+{
+    int best = 0;
+
+    for (size_t i = 0; i < m_replicates.size(); ++i)
+    {
+        if (!finished_with_ballot(i))
+            continue;
+
+#ifdef SIMULATION
+        // Simulated runs have no output, a sampled fault is a crash
+        best++;
+#else
+        const ballot *lhs = m_replicates[i]->get_ballot();
+        int count = 0;
+
+        for (size_t j = 0; j < m_replicates.size(); ++j)
+        {
+            const ballot *rhs = m_replicates[j]->get_ballot();
+
+            if (finished_with_ballot(j) && rhs->chain == lhs->chain && rhs->digest == lhs->digest)
+                count++;
+        }
+
+        if (count > best)
+            best = count;
+#endif
+    }
+
+    return best;
+}
+
+bool voter::finished_with_ballot(size_t i)
+{
+    task *r = m_replicates[i];
+
+    if (r->get_state() == task_state::running || r->get_state() == task_state::crashed)
+        return false;
+
+#ifdef SIMULATION
+    return true;
+#else
+    // A ballot of an earlier run belongs to an earlier round
+    return r->get_ballot()->run.load(std::memory_order_acquire) == r->get_runs();
+#endif
 }
 
 bool voter::check_replicate_state(task_state state)
@@ -31,7 +95,11 @@ bool voter::check_replicate_state(task_state state)
 
 bool voter::get_voter_fireable()
 {
-    int at_least_one_survivor = false;
+    if (m_deferred)
+    {
+        m_deferred = false;
+        return true;
+    }
 
     // Check if the voter is armed
     if (!m_armed)
@@ -40,7 +108,9 @@ bool voter::get_voter_fireable()
         bool armed = true;
         for (size_t i = 0; i < m_replicates.size(); ++i)
         {
-            if (m_replicates[i]->get_state() == task_state::running)
+            // A laggard of an early vote only arms the voter once it has been dispatched again
+            if (m_replicates[i]->get_state() == task_state::running &&
+                m_replicates[i]->get_runs() != m_replicateMonitor[i].laggardRun)
                 m_replicateMonitor[i].armed = true;
 
             if (!m_replicateMonitor[i].armed)
@@ -51,7 +121,10 @@ bool voter::get_voter_fireable()
         return false;
     }
 
-    // Check if all replicates are no longer running
+    // Count the replicates that finished successfully and check if any are still running
+    int survivors = 0;
+    bool running = false;
+
     for (size_t i = 0; i < m_replicates.size(); ++i)
     {
         if (m_replicates[i]->get_state() != task_state::running)
@@ -59,20 +132,43 @@ bool voter::get_voter_fireable()
             m_replicateMonitor[i].armed = false;
 
             if (m_replicates[i]->get_state() != task_state::crashed)
-            {
-                at_least_one_survivor = true;
-            }
+                survivors++;
         }
 
         if (m_replicateMonitor[i].armed)
-            return false;
+            running = true;
     }
 
+    // Wait for all replicates, unless enough of them finished with the same output to reach the quorum.
+    // Replicates that disagree keep the laggards running, the full vote decides
+    if (running && (m_quorum <= 0 || count_agreeing() < m_quorum))
+        return false;
+
     // Check if there is atleast one replicate with input
-    if (!at_least_one_survivor)
+    if (!survivors)
         return false;
 
-    // If all replicates are no longer running, reset armed state and return true
+    // The replicates that are still running belong to this round, do not let them arm the next one
+    m_lastLaggards.clear();
+
+    if (running)
+    {
+        for (size_t i = 0; i < m_replicates.size(); ++i)
+        {
+            if (!m_replicateMonitor[i].armed)
+                continue;
+
+            m_replicateMonitor[i].armed = false;
+            m_replicateMonitor[i].laggardRun = m_replicates[i]->get_runs();
+            m_lastLaggards.push_back(m_replicates[i]);
+            m_laggards++;
+        }
+
+        m_earlyVotes++;
+    }
+
+    // Reset armed state and return true
+    m_votes++;
     m_armed = false;
     return true;
-}
\ No newline at end of file
+}
@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sched.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <sys/prctl.h>
+#include <algorithm>
+
+#include <worker.h>
+
+vector<int> worker::s_schedulerFds;
+
+worker::worker(int coreID)
+{
+    m_coreID = coreID;
+}
+
+worker* worker::declare_worker(int coreID)
+{
+    worker* w = new worker(coreID);
+    return w;
+}
+
+void worker::spawn(vector<task*> &tasks, event_loop *events)
+{
+    int control_fds[2];
+    int status_fds[2];
+
+    if (pipe(control_fds) == -1 || pipe(status_fds) == -1)
+    {
+        perror("pipe");
+        exit(EXIT_FAILURE);
+    }
+
+    pid_t pid = fork();
+
+    if (pid == -1)
+        exit(EXIT_FAILURE);
+    else if (pid == 0)
+    {
+        close(control_fds[1]);
+        close(status_fds[0]);
+
+        // A worker only needs its own pipes, the ones of the other workers would outlive their workers
+        for (int fd : s_schedulerFds)
+            close(fd);
+
+        s_schedulerFds.clear();
+
+        if (events != NULL)
+            events->reset_child_signals();
+
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(CONFIG.cpu_base + m_coreID, &cpuset);
+
+        char name[16];
+        snprintf(name, sizeof(name), "worker_%d", m_coreID);
+
+        if (prctl(PR_SET_NAME, (unsigned long) name) < 0)
+            perror("prctl()");
+
+        if (sched_setaffinity(0, sizeof(cpuset), &cpuset) != 0)
+        {
+            perror("sched_setaffinity");
+            exit(EXIT_FAILURE);
+        }
+
+        worker_loop(tasks, control_fds[0], status_fds[1]);
+    }
+
+    close(control_fds[0]);
+    close(status_fds[1]);
+    fcntl(status_fds[0], F_SETFL, O_NONBLOCK);
+
+    m_pid = pid;
+    m_control_fd = control_fds[1];
+    m_status_fd = status_fds[0];
+    m_alive = true;
+    m_job = NULL;
+    m_spawns++;
+
+    s_schedulerFds.push_back(m_control_fd);
+    s_schedulerFds.push_back(m_status_fd);
+
+    if (events != NULL)
+    {
+        // Edge triggered, a worker that dies while idle is only noticed on its next dispatch
+        m_pidfd = events->watch_child(pid, &m_exitEvent, true);
+        events->watch_fd(m_status_fd, &m_statusEvent, false);
+    }
+}
+
+void worker::worker_loop(vector<task*> &tasks, int control_fd, int status_fd)
+{
+    job_descriptor job;
+
+    while (read(control_fd, &job, sizeof(job)) == sizeof(job))
+    {
+        job_report report;
+        struct rusage before, after;
+
+        getrusage(RUSAGE_SELF, &before);
+
+        report.task_id = job.task_id;
+        tasks[job.task_id]->set_runs(job.run);
+        report.status = W_EXITCODE(tasks[job.task_id]->run() & 0xff, 0);
+
+        getrusage(RUSAGE_SELF, &after);
+        report.usage = usage_from_rusage(after, &before);
+
+        fflush(stdout);
+
+        if (write(status_fd, &report, sizeof(report)) != sizeof(report))
+            break;
+    }
+
+    _exit(EXIT_SUCCESS);
+}
+
+pid_t worker::dispatch(task *t)
+{
+    job_descriptor job;
+    job.task_id = t->get_id();
+    job.run = t->get_runs();
+
+    if (!m_alive || write(m_control_fd, &job, sizeof(job)) != sizeof(job))
+        return -1;
+
+    m_job = t;
+
+    return m_pid;
+}
+
+pid_t worker::poll(int *status, job_usage *usage)
+{
+    job_report report;
+
+    if (read(m_status_fd, &report, sizeof(report)) == sizeof(report))
+    {
+        *status = report.status;
+        *usage = report.usage;
+        return m_pid;
+    }
+
+    // No report, check whether the worker died while running the job
+    pid_t result = waitpid(m_pid, status, WNOHANG);
+
+    if (result != 0)
+        m_alive = false;
+
+    return result;
+}
+
+void worker::kill_worker(event_loop *events)
+{
+    if (m_alive)
+    {
+        kill(m_pid, SIGKILL);
+        waitpid(m_pid, NULL, 0);
+        m_alive = false;
+    }
+
+    forget_fd(m_control_fd);
+    forget_fd(m_status_fd);
+
+    if (events != NULL)
+    {
+        events->unwatch_fd(m_pidfd);
+        events->unwatch_fd(m_status_fd);
+    }
+    else
+        close(m_status_fd);
+
+    close(m_control_fd);
+
+    m_pidfd = -1;
+    m_status_fd = -1;
+    m_control_fd = -1;
+    m_job = NULL;
+}
+
+void worker::forget_fd(int fd)
+{
+    auto it = find(s_schedulerFds.begin(), s_schedulerFds.end(), fd);
+
+    if (it != s_schedulerFds.end())
+        s_schedulerFds.erase(it);
+}
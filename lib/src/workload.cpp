@@ -0,0 +1,348 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <random>
+#include <algorithm>
+
+#include <workload.h>
+#include <voter.h>
+#include <timer.h>
+
+// Busy-waits the sampled cost of the current run and fails it with the fault rate of the task
+static void workload_spend(task *t)
+{
+    const task_cost &cost = t->get_cost();
+
+    // The scheduler increments the runs before the dispatch, so every run draws a different cost
+    mt19937 rng(t->get_id() * 2654435761u + t->get_runs());
+    uniform_int_distribution<int> jitter(-cost.jitter, cost.jitter);
+    bernoulli_distribution fault(cost.fault_rate);
+
+    Timer timer;
+    while (!timer.hasElapsedMilliseconds(cost.mean + jitter(rng)));
+
+    if (fault(rng))
+        task_exit(1);
+}
+
+static void workload_emit(task *t, uint64_t token)
+{
+    for (output *out = t->get_outputs(); out != NULL; out = out->next)
+    {
+        if (out->pipe != NULL)
+            out->pipe->write_raw(&token, sizeof(token));
+    }
+}
+
+void workload_job()
+{
+    task *t = task::get_current();
+    uint64_t token = t->get_runs();
+
+    input_table &inputs = t->get_inputs();
+
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        if (inputs.get_pipe(i) != NULL)
+            inputs.get_pipe(i)->read_latest_raw(&token, sizeof(token));
+    }
+
+    workload_spend(t);
+    workload_emit(t, token);
+
+    // The replicates of a stage pass on the same token
+    task_vote((uint32_t)token, token);
+}
+
+void workload_vote()
+{
+    voter *v = static_cast<voter*>(task::get_current());
+    uint64_t token = 0, newest = 0;
+    int valid = 0;
+
+    // The replicates write to the voter only. A laggard of an earlier round may have left an older token
+    for (task *replicate : v->get_replicates())
+    {
+        for (output *out = replicate->get_outputs(); out != NULL; out = out->next)
+        {
+            if (out->pipe != NULL && out->pipe->read_latest_raw(&token, sizeof(token)))
+            {
+                newest = max(newest, token);
+                valid++;
+            }
+        }
+    }
+
+    workload_spend(v);
+
+    if (!valid)
+        task_exit(1);
+
+    workload_emit(v, newest);
+}
+
+workload::workload(const workload_params &params)
+{
+    m_params = params;
+}
+
+workload* workload::declare_workload(const workload_params &params)
+{
+    workload *w = new workload(params);
+    w->generate();
+
+    return w;
+}
+
+void workload::generate()
+{
+    mt19937 rng(m_params.seed);
+    int stages = max(m_params.stages, 1);
+    int layers = max(min(m_params.layers, stages), 1);
+    int replicas = max(m_params.replicas, 1);
+
+    uniform_int_distribution<int> fan_in(1, max(m_params.max_fan_in, 1));
+    uniform_int_distribution<size_t> period(0, m_params.periods.empty() ? 0 : m_params.periods.size() - 1);
+    bernoulli_distribution replicated(replicas > 1 ? m_params.replicated : 0.0);
+
+    // The stages are spread evenly over the layers, the first stage of layer l is ceil(l * stages / layers)
+    auto first_of = [&](int layer) { return (int)(((long)layer * stages + layers - 1) / layers); };
+    int sources = first_of(1);
+
+    m_stages.assign(stages, workload_stage { 0, 0, {}, 0, false });
+
+    int layer = 1;
+
+    for (int i = 0; i < stages; i++)
+    {
+        workload_stage &stage = m_stages[i];
+
+        if (i < sources)
+        {
+            stage.period = m_params.periods.empty() ? TASK_BUSY_TIME : m_params.periods[period(rng)];
+            continue;
+        }
+
+        while (layer + 1 < layers && i >= first_of(layer + 1))
+            layer++;
+
+        // Layered graphs read from the previous layer, random graphs from any earlier stage
+        int low = m_params.layered ? first_of(layer - 1) : 0;
+        int high = m_params.layered ? first_of(layer) - 1 : i - 1;
+        uniform_int_distribution<int> pick(low, high);
+
+        int wanted = min(fan_in(rng), high - low + 1);
+        int fallback = -1;
+
+        for (int attempt = 0; attempt < 4 * wanted && (int)stage.inputs.size() < wanted; attempt++)
+        {
+            int producer = pick(rng);
+
+            if (find(stage.inputs.begin(), stage.inputs.end(), producer) != stage.inputs.end())
+                continue;
+
+            if (m_stages[producer].consumers >= m_params.max_fan_out)
+            {
+                if (fallback == -1 || m_stages[producer].consumers < m_stages[fallback].consumers)
+                    fallback = producer;
+
+                continue;
+            }
+
+            stage.inputs.push_back(producer);
+        }
+
+        if (stage.inputs.empty())
+            stage.inputs.push_back(fallback);
+
+        stage.layer = 0;
+
+        for (int producer : stage.inputs)
+        {
+            m_stages[producer].consumers++;
+            stage.layer = max(stage.layer, m_stages[producer].layer + 1);
+        }
+
+        stage.replicated = replicated(rng);
+    }
+}
+
+size_t workload::get_pipes()
+{
+    size_t pipes = 0;
+    int replicas = max(m_params.replicas, 1);
+
+    // A replicate gets its own copy of every input and a pipe to the voter
+    for (const workload_stage &stage : m_stages)
+        pipes += stage.replicated ? replicas * (stage.inputs.size() + 1) : stage.inputs.size();
+
+    return pipes;
+}
+
+Pipe* workload::connect(task *producer, task *consumer, const string &name)
+{
+#ifdef SIMULATION
+    Pipe *p = new Pipe(-1, -1, name.c_str());
+#else
+    Pipe *p = Pipe::declare_pipe(name.c_str());
+#endif
+
+    producer->add_output(p);
+
+    if (consumer != NULL)
+        consumer->add_input(p, sizeof(uint64_t));
+
+    m_pipes.push_back(p);
+    return p;
+}
+
+void workload::build(scheduler *s)
+{
+    int replicas = max(m_params.replicas, 1);
+
+    m_producers.assign(m_stages.size(), NULL);
+
+    for (size_t i = 0; i < m_stages.size(); i++)
+    {
+        const workload_stage &stage = m_stages[i];
+        string name = "w" + to_string(i);
+
+        // The next layer is monitored first, so the graph drains before new data enters it
+        int priority = 2 * stage.layer;
+
+        if (!stage.replicated)
+        {
+            task *t = task::declare_task(name, stage.period, 0, priority, workload_job);
+            t->set_cost(m_params.cost_mean, m_params.cost_jitter, m_params.fault_rate);
+
+            for (int producer : stage.inputs)
+                connect(m_producers[producer], t, "w" + to_string(producer) + "_" + name);
+
+            s->add_task(t);
+            m_producers[i] = t;
+            m_tasks++;
+
+            continue;
+        }
+
+        voter *v = voter::declare_voter(name + "_voter", 0, 0, priority + 1, workload_vote, voter_type::standard);
+        v->set_cost(1, 0, 0.0);
+
+        for (int r = 1; r <= replicas; r++)
+        {
+            string replicate_name = name + "_" + to_string(r);
+            task *t = task::declare_task(replicate_name, 0, 0, priority, workload_job);
+            t->set_cost(m_params.cost_mean, m_params.cost_jitter, m_params.fault_rate);
+
+            for (int producer : stage.inputs)
+                connect(m_producers[producer], t, "w" + to_string(producer) + "_" + replicate_name);
+
+            // The voter reads the outputs of its replicates itself
+            connect(t, NULL, replicate_name + "_voter");
+
+            v->add_replicate(t);
+            s->add_task(t);
+            m_tasks++;
+        }
+
+        s->add_task(v);
+        m_producers[i] = v;
+        m_tasks++;
+        m_voters++;
+    }
+}
+
+// Writes a list of strings in graph file syntax
+static void write_list(FILE *file, const char *key, const vector<string> &items)
+{
+    fprintf(file, "%s = [", key);
+
+    for (size_t i = 0; i < items.size(); i++)
+        fprintf(file, "%s\"%s\"", i ? ", " : "", items[i].c_str());
+
+    fprintf(file, "]\n");
+}
+
+void workload::write_graph(FILE *file)
+{
+    int replicas = max(m_params.replicas, 1);
+
+    // The names of the tasks, voters and pipes are the ones build() declares
+    vector<vector<string>> outputs(m_stages.size());
+
+    for (size_t i = 0; i < m_stages.size(); i++)
+    {
+        const workload_stage &stage = m_stages[i];
+        string name = "w" + to_string(i);
+
+        for (int producer : stage.inputs)
+        {
+            if (!stage.replicated)
+                outputs[producer].push_back("w" + to_string(producer) + "_" + name);
+            else
+            {
+                for (int r = 1; r <= replicas; r++)
+                    outputs[producer].push_back("w" + to_string(producer) + "_" + name + "_" + to_string(r));
+            }
+        }
+    }
+
+    fprintf(file, "# Generated by the workload generator: %d stages, seed %u\n", (int)m_stages.size(), m_params.seed);
+    fprintf(file, "name = \"workload_%d\"\n", (int)m_stages.size());
+
+    for (size_t i = 0; i < m_stages.size(); i++)
+    {
+        const workload_stage &stage = m_stages[i];
+        string name = "w" + to_string(i);
+        int priority = 2 * stage.layer;
+
+        int copies = stage.replicated ? replicas : 1;
+        vector<string> replicate_names;
+
+        for (int r = 1; r <= copies; r++)
+        {
+            string task_name = stage.replicated ? name + "_" + to_string(r) : name;
+            vector<string> inputs;
+
+            for (int producer : stage.inputs)
+                inputs.push_back("w" + to_string(producer) + "_" + task_name);
+
+            fprintf(file, "\n[[task]]\nname = \"%s\"\n", task_name.c_str());
+
+            if (!stage.replicated && stage.period)
+                fprintf(file, "period = %lu\n", stage.period);
+
+            fprintf(file, "priority = %d\n", priority);
+            fprintf(file, "cost_mean = %d\ncost_jitter = %d\nfault_rate = %g\n", m_params.cost_mean, m_params.cost_jitter, m_params.fault_rate);
+
+            if (!inputs.empty())
+                write_list(file, "inputs", inputs);
+
+            write_list(file, "outputs", stage.replicated ? vector<string> { task_name + "_voter" } : outputs[i]);
+            replicate_names.push_back(task_name);
+        }
+
+        if (!stage.replicated)
+            continue;
+
+        fprintf(file, "\n[[voter]]\nname = \"%s_voter\"\npriority = %d\ncost_mean = 1\n", name.c_str(), priority + 1);
+        write_list(file, "replicas", replicate_names);
+        write_list(file, "outputs", outputs[i]);
+    }
+}
+
+void workload::close_pipes()
+{
+    for (Pipe *p : m_pipes)
+    {
+        if (p->get_read_fd() >= 0)
+            close(p->get_read_fd());
+
+        if (p->get_write_fd() >= 0)
+            close(p->get_write_fd());
+
+        delete p;
+    }
+
+    m_pipes.clear();
+}
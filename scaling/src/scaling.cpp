@@ -0,0 +1,180 @@
+/**
+ * @file scaling.cpp
+ * @brief Runs the scheduler on generated task graphs of growing size and reports how it scales.
+ *
+ * Usage: bin/scaling [stages | graph file ...], 100, 1000 and 10000 stages by default. Every graph runs
+ * for WORKLOAD_RUN_TIME milliseconds on a fresh scheduler, the shape and costs of the generated graphs
+ * are set in defines.h (WORKLOAD_*), a graph file is loaded with graph.h. One row per graph is written to
+ * results/scaling_<date>.tsv: the tick cost (the real time of one monitor and dispatch pass), the
+ * dispatch latency over all tasks and the throughput.
+ *
+ * bin/scaling --export <stages> prints the generated graph of that size as a graph file instead.
+ *
+ * Without SIMULATION the jobs are forked and the inputs are tracked with epoll, so a graph runs as long
+ * as its pipes fit in the descriptor limit (raised to the hard limit). With SIMULATION the pipes only
+ * count tokens.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <string>
+#include <vector>
+#include <functional>
+
+#include <scheduler.h>
+#include <workload.h>
+#include <graph.h>
+
+using namespace std;
+
+// Runs one graph and writes its row, build declares the tasks of the graph
+static void run_graph(FILE *report, int stages, size_t pipes, function<void(scheduler*)> build)
+{
+    scheduler *s = scheduler::declare_scheduler("scaling");
+    s->init_scheduler();
+    s->set_logging(false);
+
+    build(s);
+
+    int tasks = s->get_tasks().size();
+    int voters = 0;
+
+    for (task *t : s->get_tasks())
+        voters += t->get_voter();
+    printf("Running %d stages: %d tasks, %d voters, %zu pipes\n", stages, tasks, voters, pipes);
+
+    s->prepare_run();
+
+    long start = s->current_time_in_ms();
+    while (s->current_time_in_ms() - start < WORKLOAD_RUN_TIME)
+        s->run_pass();
+
+    long elapsed = s->current_time_in_ms() - start;
+
+    // Collect before the cleanup deletes the tasks
+    latency_histogram dispatch;
+    long jobs = 0;
+
+    for (task *t : s->get_tasks())
+    {
+        dispatch.merge(t->get_latency(latency_dispatch));
+        jobs += t->get_success() + t->get_fails() + t->get_errors();
+    }
+
+    const latency_histogram &tick = s->get_tick_cost();
+
+    fprintf(report, "%d\t%d\t%d\t%zu\t%lu\t%.1f\t%lu\t%lu\t%lu\t%lu\t%lu\t%ld\t%ld\t%.1f\n",
+        stages, tasks, voters, pipes, tick.get_count(),
+        tick.get_mean(), tick.percentile(50), tick.percentile(99), tick.get_max(),
+        dispatch.percentile(50), dispatch.percentile(99), jobs, elapsed, elapsed ? jobs * 1000.0 / elapsed : 0.0);
+    fflush(report);
+
+    s->cleanup_scheduler();
+}
+
+// Every pipe takes two descriptors
+static bool fits_descriptors(size_t pipes, const string &label)
+{
+#ifndef SIMULATION
+    struct rlimit files;
+
+    if (getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur != RLIM_INFINITY && 2 * pipes + 64 >= files.rlim_cur)
+    {
+        fprintf(stderr, "Skipping %s: %zu pipes do not fit in %lu descriptors, define SIMULATION\n", label.c_str(), pipes, (unsigned long)files.rlim_cur);
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc == 3 && string(argv[1]) == "--export")
+    {
+        workload_params params;
+        params.stages = atoi(argv[2]);
+
+        workload *w = workload::declare_workload(params);
+        w->write_graph(stdout);
+        delete w;
+
+        return 0;
+    }
+
+    vector<string> graphs;
+
+    for (int i = 1; i < argc; i++)
+        graphs.push_back(argv[i]);
+
+    if (graphs.empty())
+        graphs = { "100", "1000", "10000" };
+
+    // Every pipe takes two descriptors
+    struct rlimit files;
+    if (getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur < files.rlim_max)
+    {
+        files.rlim_cur = files.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &files);
+    }
+
+    char date[32];
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%d_%H-%M-%S", localtime(&now));
+
+    mkdir("results", 0755);
+    string path = string("results/scaling_") + date + ".tsv";
+    FILE *report = fopen(path.c_str(), "w");
+
+    if (!report)
+    {
+        perror("Failed to open file");
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(report, "stages\ttasks\tvoters\tpipes\tpasses\ttick_mean_ns\ttick_p50_ns\ttick_p99_ns\ttick_max_ns\t"
+        "dispatch_p50_ns\tdispatch_p99_ns\tjobs\trun_ms\tjobs_per_s\n");
+
+    for (const string &name : graphs)
+    {
+        // A number is the size of a generated graph, anything else a graph file
+        if (name.find_first_not_of("0123456789") == string::npos)
+        {
+            workload_params params;
+            params.stages = atoi(name.c_str());
+
+            workload *w = workload::declare_workload(params);
+
+            if (fits_descriptors(w->get_pipes(), name + " stages"))
+            {
+                run_graph(report, params.stages, w->get_pipes(), [w](scheduler *s) { w->build(s); });
+                w->close_pipes();
+            }
+
+            delete w;
+            continue;
+        }
+
+        graph *g = graph::load_graph(name);
+
+        if (g == NULL)
+            exit(EXIT_FAILURE);
+
+        if (fits_descriptors(g->get_pipes(), name))
+        {
+            // A replicated stage is one stage, like in a generated graph
+            run_graph(report, g->get_tasks().size() - g->get_replicas().size(), g->get_pipes(), [g](scheduler *s) { g->build(s); });
+            g->close_pipes();
+        }
+
+        delete g;
+    }
+
+    fclose(report);
+    printf("Report written to %s\n", path.c_str());
+
+    return 0;
+}
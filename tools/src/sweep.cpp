@@ -0,0 +1,358 @@
+/**
+ * @file sweep.cpp
+ * @brief Runs a grid of scheduler configurations in parallel, each on its own set of CPUs.
+ *
+ * Usage: bin/sweep <grid file>
+ *
+ * The grid file holds `key = value, value, ...` lines. The keys are the parameters of config.h
+ * (cores, busy_time, stuck_time, mode, ...), every combination of their values is one configuration. The
+ * keys below only control the sweep:
+ * - binary: the program to run, bin/main by default (a list runs every configuration with each binary)
+ * - cpus: the number of CPUs the sweep may use, all online CPUs by default
+ * - first_cpu: the first CPU the sweep may use, 0 by default
+ *
+ * A configuration is pinned to a contiguous block of cores + scheduler core CPUs (its cpu_base), so
+ * as many configurations run at once as there are free blocks. Every configuration gets a directory
+ * results/sweep_<date>/<id>/ with its parameters (config.txt, usable with --config), the output of the
+ * run (output.txt) and its result files (results/). The sweep directory holds index.tsv with one row
+ * per finished configuration.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#include <config.h>
+
+using namespace std;
+
+typedef struct sweep_run {
+    int id;
+    string binary;
+    vector<string> values;          // One value per axis
+    string directory;
+    int width;                      // Number of CPUs of the run
+    int cpu_base { -1 };
+    pid_t pid { 0 };
+    long start { 0 };
+} sweep_run;
+
+static long now_ms()
+{
+    struct timespec spec;
+    clock_gettime(CLOCK_MONOTONIC, &spec);
+    return (spec.tv_sec * 1000) + (spec.tv_nsec / 1000000);
+}
+
+static string trim(const string &text)
+{
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    size_t end = text.find_last_not_of(" \t\r\n");
+
+    return (begin == string::npos) ? "" : text.substr(begin, end - begin + 1);
+}
+
+static vector<string> split(const string &text)
+{
+    vector<string> values;
+    size_t begin = 0;
+
+    while (begin <= text.size())
+    {
+        size_t end = text.find(',', begin);
+        if (end == string::npos)
+            end = text.size();
+
+        string value = trim(text.substr(begin, end - begin));
+        if (!value.empty())
+            values.push_back(value);
+
+        begin = end + 1;
+    }
+
+    return values;
+}
+
+// Returns the first CPU of a free block of width CPUs, -1 if there is none
+static int find_block(vector<bool> &busy, int width)
+{
+    for (int first = 0; first + width <= (int)busy.size(); first++)
+    {
+        int i = 0;
+        while (i < width && !busy[first + i])
+            i++;
+
+        if (i == width)
+            return first;
+
+        first += i;
+    }
+
+    return -1;
+}
+
+static void launch(sweep_run &run)
+{
+    string config = run.directory + "/config.txt";
+    string output = run.directory + "/output.txt";
+    string results = run.directory + "/results";
+    string cpu_base = to_string(run.cpu_base);
+
+    run.start = now_ms();
+    run.pid = fork();
+
+    if (run.pid == -1)
+    {
+        perror("fork");
+        exit(EXIT_FAILURE);
+    }
+    else if (run.pid == 0)
+    {
+        int fd = open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+        if (fd != -1)
+        {
+            dup2(fd, STDOUT_FILENO);
+            dup2(fd, STDERR_FILENO);
+            close(fd);
+        }
+
+        const char *args[] = { run.binary.c_str(), "--config", config.c_str(), "--cpu_base", cpu_base.c_str(),
+            "--results", results.c_str(), NULL };
+
+        execv(run.binary.c_str(), (char* const*)args);
+        perror("execv");
+        _exit(127);
+    }
+
+    printf("Started %d on CPUs %d-%d: %s\n", run.id, run.cpu_base, run.cpu_base + run.width - 1, run.directory.c_str());
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s <grid file>\n", argv[0]);
+        config_usage(stderr, CONFIG);
+        return EXIT_FAILURE;
+    }
+
+    FILE *grid = fopen(argv[1], "r");
+
+    if (!grid)
+    {
+        perror("Failed to open file");
+        return EXIT_FAILURE;
+    }
+
+    vector<string> binaries = { "bin/main" };
+    int cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int first_cpu = 0;
+    vector<string> axes;
+    vector<vector<string>> values;
+    char line[1024];
+
+    while (fgets(line, sizeof(line), grid))
+    {
+        string text = trim(line);
+
+        if (text.empty() || text[0] == '#')
+            continue;
+
+        size_t equals = text.find('=');
+
+        if (equals == string::npos)
+        {
+            fprintf(stderr, "Expected key = value, ...: %s\n", text.c_str());
+            return EXIT_FAILURE;
+        }
+
+        string key = trim(text.substr(0, equals));
+        vector<string> list = split(text.substr(equals + 1));
+
+        if (list.empty())
+        {
+            fprintf(stderr, "No values for %s\n", key.c_str());
+            return EXIT_FAILURE;
+        }
+
+        if (key == "binary")
+            binaries = list;
+        else if (key == "cpus")
+            cpus = atoi(list[0].c_str());
+        else if (key == "first_cpu")
+            first_cpu = atoi(list[0].c_str());
+        else
+        {
+            // Check the key and every value before anything runs
+            for (const string &value : list)
+            {
+                run_config check;
+
+                if (!config_set(check, key, value))
+                    return EXIT_FAILURE;
+            }
+
+            axes.push_back(key);
+            values.push_back(list);
+        }
+    }
+
+    fclose(grid);
+
+    // Every combination of the axis values, once per binary
+    vector<sweep_run> runs;
+    vector<size_t> digits(axes.size(), 0);
+
+    char date[32];
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%d_%H-%M-%S", localtime(&now));
+    string sweep_directory = string("results/sweep_") + date;
+
+    mkdir("results", 0755);
+
+    if (mkdir(sweep_directory.c_str(), 0755) == -1)
+    {
+        perror("Error creating directory");
+        return EXIT_FAILURE;
+    }
+
+    for (const string &binary : binaries)
+    {
+        fill(digits.begin(), digits.end(), 0);
+
+        while (true)
+        {
+            sweep_run run;
+            run_config config;
+
+            run.id = runs.size();
+            run.binary = binary;
+
+            for (size_t a = 0; a < axes.size(); a++)
+            {
+                run.values.push_back(values[a][digits[a]]);
+                config_set(config, axes[a], run.values.back());
+            }
+
+            run.width = config.get_width();
+            run.directory = sweep_directory + "/" + to_string(run.id);
+
+            if (run.width > cpus)
+            {
+                fprintf(stderr, "Configuration %d needs %d CPUs, the sweep has %d\n", run.id, run.width, cpus);
+                return EXIT_FAILURE;
+            }
+
+            mkdir(run.directory.c_str(), 0755);
+
+            FILE *file = fopen((run.directory + "/config.txt").c_str(), "w");
+            if (!file)
+            {
+                perror("Failed to open file");
+                return EXIT_FAILURE;
+            }
+
+            for (size_t a = 0; a < axes.size(); a++)
+                fprintf(file, "%s = %s\n", axes[a].c_str(), run.values[a].c_str());
+
+            fclose(file);
+            runs.push_back(run);
+
+            // Next combination, the last axis changes fastest
+            int a = (int)axes.size() - 1;
+            while (a >= 0 && ++digits[a] == values[a].size())
+                digits[a--] = 0;
+
+            if (a < 0)
+                break;
+        }
+    }
+
+    FILE *index = fopen((sweep_directory + "/index.tsv").c_str(), "w");
+
+    if (!index)
+    {
+        perror("Failed to open file");
+        return EXIT_FAILURE;
+    }
+
+    fprintf(index, "id\tdirectory\tbinary");
+    for (const string &axis : axes)
+        fprintf(index, "\t%s", axis.c_str());
+    fprintf(index, "\tcpu_base\texit_status\twall_ms\n");
+
+    printf("Sweep of %zu configurations on CPUs %d-%d: %s\n", runs.size(), first_cpu, first_cpu + cpus - 1, sweep_directory.c_str());
+
+    vector<bool> busy(cpus, false);
+    map<pid_t, sweep_run*> running;
+    size_t next = 0;
+    int failed = 0;
+
+    while (next < runs.size() || !running.empty())
+    {
+        // Start runs in order while their block of CPUs fits
+        while (next < runs.size())
+        {
+            sweep_run &run = runs[next];
+            int first = find_block(busy, run.width);
+
+            if (first == -1)
+                break;
+
+            fill(busy.begin() + first, busy.begin() + first + run.width, true);
+            run.cpu_base = first_cpu + first;
+            launch(run);
+
+            running[run.pid] = &run;
+            next++;
+        }
+
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+
+        if (pid == -1)
+        {
+            perror("waitpid");
+            return EXIT_FAILURE;
+        }
+
+        auto it = running.find(pid);
+        if (it == running.end())
+            continue;
+
+        sweep_run &run = *it->second;
+        running.erase(it);
+
+        int first = run.cpu_base - first_cpu;
+        fill(busy.begin() + first, busy.begin() + first + run.width, false);
+
+        // A run killed by a signal is recorded as 128 + the signal, like a shell does
+        int exit_status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+        long wall = now_ms() - run.start;
+
+        if (exit_status)
+            failed++;
+
+        fprintf(index, "%d\t%s\t%s", run.id, run.directory.c_str(), run.binary.c_str());
+        for (const string &value : run.values)
+            fprintf(index, "\t%s", value.c_str());
+        fprintf(index, "\t%d\t%d\t%ld\n", run.cpu_base, exit_status, wall);
+        fflush(index);
+
+        printf("Finished %d with status %d after %ld ms\n", run.id, exit_status, wall);
+    }
+
+    fclose(index);
+    printf("Index written to %s/index.tsv, %d of %zu configurations failed\n", sweep_directory.c_str(), failed, runs.size());
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file trace2tsv.cpp
+ * @brief Converts a trace.bin (see trace.h) back into cores.tsv, weights.tsv, tasks.tsv and summary.txt.
+ *
+ * Usage: trace2tsv <trace.bin> [output directory]
+ *
+ * The files are written next to the trace unless an output directory is given, in the same layout
+ * as the scheduler writes them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include <trace.h>
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <trace.bin> [output directory]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    string path = argv[1];
+    string directory = (argc > 2) ? argv[2] : path.substr(0, path.find_last_of('/') == string::npos ? 0 : path.find_last_of('/'));
+
+    if (directory.empty())
+        directory = ".";
+
+    trace_reader reader;
+    if (!reader.open(path))
+    {
+        fprintf(stderr, "Not a valid trace: %s\n", path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    FILE *core_file = fopen((directory + "/cores.tsv").c_str(), "w");
+    FILE *weight_file = fopen((directory + "/weights.tsv").c_str(), "w");
+    FILE *task_file = fopen((directory + "/tasks.tsv").c_str(), "w");
+
+    if (!core_file || !weight_file || !task_file)
+    {
+        perror("Failed to open file");
+        return EXIT_FAILURE;
+    }
+
+    // Banners
+    fprintf(core_file, "time");
+    fprintf(weight_file, "time");
+    fprintf(task_file, "time");
+
+    for (size_t i = 0; i < reader.get_cores(); i++)
+    {
+        fprintf(core_file, "\tcore_%ld", i);
+        fprintf(weight_file, "\tcore_%ld", i);
+    }
+
+    for (const string &name : reader.get_names())
+        fprintf(task_file, "\t%s", name.c_str());
+
+    fprintf(core_file, "\n");
+    fprintf(weight_file, "\n");
+    fprintf(task_file, "\n");
+
+    trace_sample sample;
+    size_t samples = 0;
+
+    while (reader.next_sample(sample))
+    {
+        fprintf(core_file, "%ld", sample.time);
+        fprintf(weight_file, "%ld", sample.time);
+        fprintf(task_file, "%ld", sample.time);
+
+        for (size_t j = 0; j < sample.core_runs.size(); j++)
+        {
+            fprintf(core_file, "\t%d", sample.core_runs[j]);
+            fprintf(weight_file, "\t%f", sample.weights[j]);
+        }
+
+        for (size_t j = 0; j < sample.task_success.size(); j++)
+            fprintf(task_file, "\t%d", sample.task_success[j]);
+
+        fprintf(core_file, "\n");
+        fprintf(weight_file, "\n");
+        fprintf(task_file, "\n");
+
+        samples++;
+    }
+
+    fclose(core_file);
+    fclose(weight_file);
+    fclose(task_file);
+
+    size_t summary_size;
+    const char *summary = reader.get_summary(summary_size);
+
+    if (summary != NULL)
+    {
+        FILE *summary_file = fopen((directory + "/summary.txt").c_str(), "w");
+
+        if (!summary_file)
+        {
+            perror("Failed to open file");
+            return EXIT_FAILURE;
+        }
+
+        fwrite(summary, 1, summary_size, summary_file);
+        fclose(summary_file);
+    }
+
+    printf("%zu samples written to %s\n", samples, directory.c_str());
+    return EXIT_SUCCESS;
+}